@@ -0,0 +1 @@
+../../ligra/directionPolicy.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../ligra/edgeMapReduce.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../ligra/histogram.h
\ No newline at end of file
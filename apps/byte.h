@@ -0,0 +1 @@
+../ligra/byte.h
\ No newline at end of file
@@ -0,0 +1 @@
+../ligra/byteRLE-pd.h
\ No newline at end of file
@@ -0,0 +1 @@
+../ligra/compressedVertex.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../ligra/frontierPool.h
\ No newline at end of file
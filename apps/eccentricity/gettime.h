@@ -0,0 +1 @@
+../../ligra/gettime.h
\ No newline at end of file
@@ -0,0 +1 @@
+../ligra/edgeMapAsync.h
\ No newline at end of file
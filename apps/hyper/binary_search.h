@@ -0,0 +1 @@
+../../ligra/binary_search.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../ligra/bucket.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../ligra/counting_sort.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../utils/transpose.h
\ No newline at end of file
@@ -0,0 +1 @@
+../ligra/memMap.h
\ No newline at end of file
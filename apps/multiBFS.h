@@ -0,0 +1 @@
+../ligra/multiBFS.h
\ No newline at end of file
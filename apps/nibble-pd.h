@@ -0,0 +1 @@
+../ligra/nibble-pd.h
\ No newline at end of file
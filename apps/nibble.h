@@ -0,0 +1 @@
+../ligra/nibble.h
\ No newline at end of file
@@ -0,0 +1 @@
+../ligra/pageAlloc.h
\ No newline at end of file
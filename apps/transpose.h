@@ -0,0 +1 @@
+../ligra/transpose.h
\ No newline at end of file
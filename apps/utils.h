@@ -0,0 +1 @@
+../ligra/utils.h
\ No newline at end of file
@@ -0,0 +1 @@
+../ligra/vertexSubset.h
\ No newline at end of file
@@ -148,20 +148,53 @@ _seq<char> mmapStringFromFile(const char *filename)
   return _seq<char>(p, n);
 }
 
-_seq<char> readStringFromFile(char *fileName)
+// Reads the first bytes bytes of fileName into buf with one pread per 8MB
+// chunk, from a parallel loop, so that each page of buf is first written by
+// the thread (and NUMA node) that reads it.
+void readFileParallel(const char *fileName, char *buf, long bytes)
 {
-  ifstream file(fileName, ios::in | ios::binary | ios::ate);
-  if (!file.is_open())
+  int fd = open(fileName, O_RDONLY);
+  if (fd < 0)
   {
     std::cout << "Unable to open file: " << fileName << std::endl;
     abort();
   }
-  long end = file.tellg();
-  file.seekg(0, ios::beg);
-  long n = end - file.tellg();
+  const long chunk = 1L << 23;
+  long chunks = (bytes + chunk - 1) / chunk;
+  parallel_for(long c = 0; c < chunks; c++)
+  {
+    long off = c * chunk, end = std::min(bytes, off + chunk);
+    while (off < end)
+    {
+      ssize_t got = pread(fd, buf + off, end - off, off);
+      if (got <= 0)
+      {
+        std::cout << "Unable to read file: " << fileName << std::endl;
+        abort();
+      }
+      off += got;
+    }
+  }
+  close(fd);
+}
+
+// Size in bytes of fileName.
+long fileSize(const char *fileName)
+{
+  struct stat sb;
+  if (stat(fileName, &sb) != 0)
+  {
+    std::cout << "Unable to open file: " << fileName << std::endl;
+    abort();
+  }
+  return sb.st_size;
+}
+
+_seq<char> readStringFromFile(char *fileName)
+{
+  long n = fileSize(fileName);
   char *bytes = newA(char, n + 1);
-  file.read(bytes, n);
-  file.close();
+  readFileParallel(fileName, bytes, n);
   return _seq<char>(bytes, n);
 }
 
@@ -252,15 +285,9 @@ graph<vertex> readGraphFromFile(char *fname, bool isSymmetric, bool mmap)
 
   uintT *offsets = newA(uintT, n);
 #ifndef WEIGHTED
-  uintE *edges = newA(uintE, m);
-  memset(edges,0,sizeof(uintE)*m);
-  unsigned long start_addr = (unsigned long)(void*)edges ;
-  for(;start_addr<start_addr+sizeof(uintE)*m;start_addr+=4096){
-  	pbbs::print_addr("edges",start_addr);
-  }
-  
+  uintE *edges = (uintE *)pageAlloc(sizeof(uintE) * m, "edges", page_policy, numa_interleave);
 #else
-  intE *edges = newA(intE, 2 * m);
+  intE *edges = (intE *)pageAlloc(sizeof(intE) * 2 * m, "edges", page_policy, numa_interleave);
 #endif
 
   {
@@ -279,21 +306,9 @@ graph<vertex> readGraphFromFile(char *fname, bool isSymmetric, bool mmap)
   }
   // W.del(); // to deal with performance bug in malloc
 
-  vertex *v = newA(vertex, n);
-
-  {
-    parallel_for(uintT i = 0; i < n; i++)
-    {
-      uintT o = offsets[i];
-      uintT l = ((i == n - 1) ? m : offsets[i + 1]) - offsets[i];
-      v[i].setOutDegree(l);
-#ifndef WEIGHTED
-      v[i].setOutNeighbors(edges + o);
-#else
-      v[i].setOutNeighbors(edges + 2 * o);
-#endif
-    }
-  }
+  long nv = n + vertexView<vertex>::extra;
+  vertex *v = (vertex *)pageAlloc(sizeof(vertex) * nv, "Vertices", page_policy, numa_partition);
+  setEdges(v, n, m, offsets, edges, false);
 
   if (!isSymmetric)
   {
@@ -338,10 +353,10 @@ graph<vertex> readGraphFromFile(char *fname, bool isSymmetric, bool mmap)
 
     tOffsets[temp[0].first] = 0;
 #ifndef WEIGHTED
-    uintE *inEdges = newA(uintE, m);
+    uintE *inEdges = (uintE *)pageAlloc(sizeof(uintE) * m, "inEdges", page_policy, numa_interleave);
     inEdges[0] = temp[0].second;
 #else
-    intE *inEdges = newA(intE, 2 * m);
+    intE *inEdges = (intE *)pageAlloc(sizeof(intE) * 2 * m, "inEdges", page_policy, numa_interleave);
     inEdges[0] = temp[0].second.first;
     inEdges[1] = temp[0].second.second;
 #endif
@@ -367,19 +382,7 @@ graph<vertex> readGraphFromFile(char *fname, bool isSymmetric, bool mmap)
     // offset to the right
     sequence::scanIBack(tOffsets, tOffsets, n, minF<uintT>(), (uintT)m);
 
-    {
-      parallel_for(long i = 0; i < n; i++)
-      {
-        uintT o = tOffsets[i];
-        uintT l = ((i == n - 1) ? m : tOffsets[i + 1]) - tOffsets[i];
-        v[i].setInDegree(l);
-#ifndef WEIGHTED
-        v[i].setInNeighbors(inEdges + o);
-#else
-        v[i].setInNeighbors(inEdges + 2 * o);
-#endif
-      }
-    }
+    setEdges(v, n, m, tOffsets, inEdges, true);
 
     free(tOffsets);
     Uncompressed_Mem<vertex> *mem = new Uncompressed_Mem<vertex>(v, n, m, edges, inEdges);
@@ -422,57 +425,22 @@ graph<vertex> readGraphFromBinary(char *iFile, bool isSymmetric)
   in >> n;
   in.close();
   
-  ifstream in2(adjFile, ifstream::in | ios::binary); // stored as uints
-  in2.seekg(0, ios::end);
-  long size = in2.tellg();
-  in2.seekg(0);
+  long size = fileSize(adjFile); // stored as uints
 #ifdef WEIGHTED
   long m = size / (2 * sizeof(uint));
 #else
   // m记录了adj文件的uint的数量
   long m = size / sizeof(uint);
 #endif
-  //char *s = (char *)malloc(size);
-  long page_to_allocate = size / 2097152 ;
-  if(page_to_allocate==0)page_to_allocate=1;
-  else{
-  	page_to_allocate+=1;
-  }
-  long mmap_size = 2097152 * page_to_allocate;
-  //printf("mmap_size is %ld",mmap_size);
-  //printf("size is %ld",size);
-  char *s = (char*)mmap(NULL, mmap_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,-1, 0);
-  if(s == MAP_FAILED){
-	printf("mmap failed!\n")	;
-	exit(-1);
-  } 
-  //printf("mmap success!\n");
-  //char *s_end = s+size;
-  memset(s,49,size);
-  //printf("mmap memset\n");
-  //char *p=s;
-  unsigned long start_addr = (unsigned long)(void*)s ;
-  unsigned long end_addr = (unsigned long)(void*)s+size;
-  unsigned long p = start_addr;
-  for(;p<end_addr;p+=2097152){
-  	pbbs::print_addr("edges",(unsigned long)(void*)p);
-  } 
-  //printf("done\n");
-  //pbbs::print_address("edges",start_addr,start_addr+size-4096);
-  //printf("mmap address\n");
-  //pbbs::print_address("edges range",start_addr,end_addr);
-  in2.read(s, size);
-  in2.close();
+  char *s = (char *)pageAlloc(size, "edges", page_policy, numa_interleave);
+  readFileParallel(adjFile, s, size);
   //[内存]edges是邻接数组，例如: edges=[2,3,4,5,6], idx=[0,2,....]，则可以认为，vertex(0)的临点是2和3，vertex(1)的临点是4,5,6。
   uintE *edges = (uintE *)s;
 
 
 
   // idx文件保存的数据格式和n相同，并且数据类型是intT
-  ifstream in3(idxFile, ifstream::in | ios::binary); // stored as longs
-  in3.seekg(0, ios::end);
-  size = in3.tellg();
-  in3.seekg(0);
+  size = fileSize(idxFile); // stored as longs
   if (n != size / sizeof(intT))
   {
     cout << "File size wrong\n";
@@ -480,28 +448,15 @@ graph<vertex> readGraphFromBinary(char *iFile, bool isSymmetric)
   }
 
   char *t = (char *)malloc(size);
-  in3.read(t, size);
-  in3.close();
+  readFileParallel(idxFile, t, size);
   //这个offset保存了idx文件的所有信息，用一个连续数据保存，
   uintT *offsets = (uintT *)t;
   //[内存]这个点集需要监控的。
   //vertex *v = newA(vertex, n);
-  int page_num = (n*sizeof(vertex))/2097152 + 1;
-  long vertex_size = page_num * 2097152;
-  vertex *v = (vertex*)mmap(NULL, vertex_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,-1, 0);
-  if(v == MAP_FAILED){
-	printf("mmap failed!\n")	;
-	exit(-1);
-  } 
-  memset(v,3,sizeof(vertex)*n);
-  start_addr = (unsigned long)(void*)v ;
-  end_addr = ((unsigned long)(void*)v) + sizeof(vertex)*n;
-  p = start_addr;
-  for(;p<end_addr;p+=2097152){
-  	pbbs::print_addr("Vertices",(unsigned long)(void*)p);
-  }
+  long nv = n + vertexView<vertex>::extra;
+  vertex *v = (vertex *)pageAlloc(sizeof(vertex) * nv, "Vertices", page_policy, numa_partition);
 #ifdef WEIGHTED
-  intE *edgesAndWeights = newA(intE, 2 * m);
+  intE *edgesAndWeights = (intE *)pageAlloc(sizeof(intE) * 2 * m, "weightedEdges", page_policy, numa_interleave);
   {
     parallel_for(long i = 0; i < m; i++)
     {
@@ -511,21 +466,13 @@ graph<vertex> readGraphFromBinary(char *iFile, bool isSymmetric)
   }
   // free(edges);
 #endif
-  {
-    //这个结构我们在graph500见过，idx表示点vertex_i，offset(也就是adj结构)的offset[i+1]-offset[i]里保存的都是这个vertex_i的临点。
-    parallel_for(long i = 0; i < n; i++)
-    {
-      uintT o = offsets[i];
-      uintT l = ((i == n - 1) ? m : offsets[i + 1]) - offsets[i];
-      //通过edge数组的起始地址和临边数量可以直接在edges数组里找到某个点的所有临点。
-      v[i].setOutDegree(l);
+  //这个结构我们在graph500见过，idx表示点vertex_i，offset(也就是adj结构)的offset[i+1]-offset[i]里保存的都是这个vertex_i的临点。
+  //通过edge数组的起始地址和临边数量可以直接在edges数组里找到某个点的所有临点。
 #ifndef WEIGHTED
-      v[i].setOutNeighbors((uintE *)edges + o);
+  setEdges(v, n, m, offsets, edges, false);
 #else
-      v[i].setOutNeighbors(edgesAndWeights + 2 * o);
+  setEdges(v, n, m, offsets, edgesAndWeights, false);
 #endif
-    }
-  }
   //[BFS]无向图都是Symmetric，所以我们的BFS不走这个逻辑
   if (!isSymmetric)
   {
@@ -568,10 +515,10 @@ graph<vertex> readGraphFromBinary(char *iFile, bool isSymmetric)
 #endif
     tOffsets[temp[0].first] = 0;
 #ifndef WEIGHTED
-    uintE *inEdges = newA(uintE, m);
+    uintE *inEdges = (uintE *)pageAlloc(sizeof(uintE) * m, "inEdges", page_policy, numa_interleave);
     inEdges[0] = temp[0].second;
 #else
-    intE *inEdges = newA(intE, 2 * m);
+    intE *inEdges = (intE *)pageAlloc(sizeof(intE) * 2 * m, "inEdges", page_policy, numa_interleave);
     inEdges[0] = temp[0].second.first;
     inEdges[1] = temp[0].second.second;
 #endif
@@ -594,19 +541,7 @@ graph<vertex> readGraphFromBinary(char *iFile, bool isSymmetric)
     // fill in offsets of degree 0 vertices by taking closest non-zero
     // offset to the right
     sequence::scanIBack(tOffsets, tOffsets, n, minF<uintT>(), (uintT)m);
-    {
-      parallel_for(long i = 0; i < n; i++)
-      {
-        uintT o = tOffsets[i];
-        uintT l = ((i == n - 1) ? m : tOffsets[i + 1]) - tOffsets[i];
-        v[i].setInDegree(l);
-#ifndef WEIGHTED
-        v[i].setInNeighbors((uintE *)inEdges + o);
-#else
-        v[i].setInNeighbors((intE *)(inEdges + 2 * o));
-#endif
-      }
-    }
+    setEdges(v, n, m, tOffsets, inEdges, true);
     free(tOffsets);
 #ifndef WEIGHTED
     Uncompressed_Mem<vertex> *mem = new Uncompressed_Mem<vertex>(v, n, m, edges, inEdges);
@@ -633,10 +568,10 @@ template <class vertex>
 graph<vertex> readGraph(char *iFile, bool compressed, bool symmetric, bool binary, bool mmap)
 {
   //可以以binary或者file方式
-  if (binary)
-    return readGraphFromBinary<vertex>(iFile, symmetric);
-  else
-    return readGraphFromFile<vertex>(iFile, symmetric, mmap);
+  graph<vertex> G = binary ? readGraphFromBinary<vertex>(iFile, symmetric)
+                           : readGraphFromFile<vertex>(iFile, symmetric, mmap);
+  G.numaReplicate();
+  return G;
 }
 
 template <class vertex>
@@ -662,14 +597,10 @@ graph<vertex> readCompressedGraph(char *fname, bool isSymmetric, bool mmap)
   }
   else
   {
-    ifstream in(fname, ifstream::in | ios::binary);
-    in.seekg(0, ios::end);
-    long size = in.tellg();
-    in.seekg(0);
+    long size = fileSize(fname);
     cout << "size = " << size << endl;
-    s = (char *)malloc(size);
-    in.read(s, size);
-    in.close();
+    s = (char *)pageAlloc(size, "edges", page_policy, numa_interleave);
+    readFileParallel(fname, s, size);
   }
 
   long *sizes = (long *)s;
@@ -708,7 +639,7 @@ graph<vertex> readCompressedGraph(char *fname, bool isSymmetric, bool mmap)
     inDegrees = Degrees;
   }
 
-  vertex *V = newA(vertex, n);
+  vertex *V = (vertex *)pageAlloc(sizeof(vertex) * n, "Vertices", page_policy, numa_partition);
   parallel_for(long i = 0; i < n; i++)
   {
     long o = offsets[i];
@@ -732,5 +663,6 @@ graph<vertex> readCompressedGraph(char *fname, bool isSymmetric, bool mmap)
   Compressed_Mem<vertex> *mem = new Compressed_Mem<vertex>(V, s);
 
   graph<vertex> G(V, n, m, mem);
+  G.numaReplicate();
   return G;
 }
@@ -101,10 +101,12 @@ inline uintE eatEdge(uchar* &start) {
 /*
   The main decoding work-horse. First eats the specially coded first
   edge, and then eats the remaining |d-1| many edges that are normally
-  coded.
+  coded. Only the chunks of PARALLEL_DEGREE edges in [chunkLo, chunkHi)
+  are decoded (by default all of them).
 */
 template <class T>
-  inline void decode(T t, uchar* edgeStart, const uintE &source, const uintT &degree, const bool par=true) {
+  inline void decode(T t, uchar* edgeStart, const uintE &source, const uintT &degree, const bool par=true,
+                     long chunkLo=0, long chunkHi=LONG_MAX) {
   if (degree > 0) {
     long numChunks = 1+(degree-1)/PARALLEL_DEGREE;
     uintE* pOffsets = (uintE*) edgeStart; //use beginning of edgeArray for offsets into edge list
@@ -112,18 +114,20 @@ template <class T>
     //do first chunk
     long end = min<long>(PARALLEL_DEGREE,degree);
 
-    // Eat first edge, which is compressed specially
-    uintE startEdge = eatFirstEdge(start,source);
-    if(!t.srcTarg(source,startEdge,0)) return;
-    for (uintE edgeID = 1; edgeID < end; edgeID++) {
-      // Eat the next 'edge', which is a difference, and reconstruct edge.
-      uintE edgeRead = eatEdge(start);
-      uintE edge = startEdge + edgeRead;
-      startEdge = edge;
-      if(!t.srcTarg(source,startEdge,edgeID)) return;
+    if (chunkLo == 0) {
+      // Eat first edge, which is compressed specially
+      uintE startEdge = eatFirstEdge(start,source);
+      if(!t.srcTarg(source,startEdge,0)) return;
+      for (uintE edgeID = 1; edgeID < end; edgeID++) {
+	// Eat the next 'edge', which is a difference, and reconstruct edge.
+	uintE edgeRead = eatEdge(start);
+	uintE edge = startEdge + edgeRead;
+	startEdge = edge;
+	if(!t.srcTarg(source,startEdge,edgeID)) return;
+      }
     }
     //do remaining chunks in parallel
-    granular_for(i, 1, numChunks, par, {
+    granular_for(i, max(1L,chunkLo), min(numChunks,chunkHi), par, {
       long o = i*PARALLEL_DEGREE;
       long end = min<long>(o+PARALLEL_DEGREE,degree);
       uchar* myStart = edgeStart + pOffsets[i-1];
@@ -143,7 +147,8 @@ template <class T>
 
 //decode edges for weighted graph
 template <class T>
-  inline void decodeWgh(T t, uchar* edgeStart, const uintE &source,const uintT &degree, const bool par=true) {
+  inline void decodeWgh(T t, uchar* edgeStart, const uintE &source,const uintT &degree, const bool par=true,
+                     long chunkLo=0, long chunkHi=LONG_MAX) {
   if (degree > 0) {
     long numChunks = 1+(degree-1)/PARALLEL_DEGREE;
     uintE* pOffsets = (uintE*) edgeStart; //use beginning of edgeArray for offsets into edge list
@@ -151,20 +156,22 @@ template <class T>
     //do first chunk
     long end = min<long>(PARALLEL_DEGREE,degree);
 
-    // Eat first edge, which is compressed specially
-    uintE startEdge = eatFirstEdge(start,source);
-    intE weight = eatWeight(start);
-    if(!t.srcTarg(source,startEdge,weight,0)) return;
-    for (uintE edgeID = 1; edgeID < end; edgeID++) {
-      // Eat the next 'edge', which is a difference, and reconstruct edge.
-      uintE edgeRead = eatEdge(start);
-      uintE edge = startEdge + edgeRead;
-      startEdge = edge;
+    if (chunkLo == 0) {
+      // Eat first edge, which is compressed specially
+      uintE startEdge = eatFirstEdge(start,source);
       intE weight = eatWeight(start);
-      if(!t.srcTarg(source,startEdge,weight,edgeID)) return;
+      if(!t.srcTarg(source,startEdge,weight,0)) return;
+      for (uintE edgeID = 1; edgeID < end; edgeID++) {
+	// Eat the next 'edge', which is a difference, and reconstruct edge.
+	uintE edgeRead = eatEdge(start);
+	uintE edge = startEdge + edgeRead;
+	startEdge = edge;
+	intE weight = eatWeight(start);
+	if(!t.srcTarg(source,startEdge,weight,edgeID)) return;
+      }
     }
     //do remaining chunks in parallel
-    granular_for(i, 1, numChunks, par, {
+    granular_for(i, max(1L,chunkLo), min(numChunks,chunkHi), par, {
       long o = i*PARALLEL_DEGREE;
       long end = min<long>(o+PARALLEL_DEGREE,degree);
       uchar* myStart = edgeStart + pOffsets[i-1];
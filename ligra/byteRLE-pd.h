@@ -104,74 +104,78 @@ inline uintE eatEdge(uchar* &start) {
 /*
   The main decoding work-horse. First eats the specially coded first
   edge, and then eats the remaining |d-1| many edges that are normally
-  coded.
+  coded. Only the chunks of PARALLEL_DEGREE edges in [chunkLo, chunkHi)
+  are decoded (by default all of them).
 */
 template <class T>
-  inline void decode(T t, uchar* edgeStart, const uintE &source, const uintT &degree, const bool par=true) {
+  inline void decode(T t, uchar* edgeStart, const uintE &source, const uintT &degree, const bool par=true,
+                     long chunkLo=0, long chunkHi=LONG_MAX) {
   if (degree > 0) {
     uintE edgesRead = 0;
     long numChunks = 1+(degree-1)/PARALLEL_DEGREE;
     uintE* pOffsets = (uintE*) edgeStart;
     uchar* start = edgeStart + (numChunks-1)*sizeof(uintE);
     long end = min<long>(PARALLEL_DEGREE,degree);
-    //do first chunk
-    // Eat first edge, which is compressed specially
-    uintE startEdge = eatFirstEdge(start,source);
-    //cout << startEdge << endl;
-    if (!t.srcTarg(source,startEdge,edgesRead)) {
-      return;
-    }
-    uintT i = 0;
-    edgesRead = 1;
-    while(1) {
-      if(edgesRead == end) break;
-      uchar header = start[i++];
-      uint numbytes = 1 + (header & 0x3);
-      uint runlength = 1 + (header >> 2);
-      switch(numbytes) {
-      case 1:
-	for(uint j = 0; j < runlength; j++) {
-	  uintE edge = (uintE) start[i++] + startEdge;
-	  startEdge = edge;
-	  if (!t.srcTarg(source, edge, edgesRead++)) {
-	    return;
+    if (chunkLo == 0) {
+      //do first chunk
+      // Eat first edge, which is compressed specially
+      uintE startEdge = eatFirstEdge(start,source);
+      //cout << startEdge << endl;
+      if (!t.srcTarg(source,startEdge,edgesRead)) {
+	return;
+      }
+      uintT i = 0;
+      edgesRead = 1;
+      while(1) {
+	if(edgesRead == end) break;
+	uchar header = start[i++];
+	uint numbytes = 1 + (header & 0x3);
+	uint runlength = 1 + (header >> 2);
+	switch(numbytes) {
+	case 1:
+	  for(uint j = 0; j < runlength; j++) {
+	    uintE edge = (uintE) start[i++] + startEdge;
+	    startEdge = edge;
+	    if (!t.srcTarg(source, edge, edgesRead++)) {
+	      return;
+	    }
 	  }
-	}
-	break;
-      case 2:
-	for(uint j = 0; j < runlength; j++) {
-	  uintE edge = (uintE) start[i] + (((uintE) start[i+1]) << 8) + startEdge;
-	  i += 2;
-	  startEdge = edge;
-	  if (!t.srcTarg(source, edge, edgesRead++)) {
-	    return;
+	  break;
+	case 2:
+	  for(uint j = 0; j < runlength; j++) {
+	    uintE edge = (uintE) start[i] + (((uintE) start[i+1]) << 8) + startEdge;
+	    i += 2;
+	    startEdge = edge;
+	    if (!t.srcTarg(source, edge, edgesRead++)) {
+	      return;
+	    }
 	  }
-	}
-	break;
-      case 3:
-	for(uint j = 0; j < runlength; j++) {
-	  uintE edge = (uintE) start[i] + (((uintE) start[i+1]) << 8) + (((uintE) start[i+2]) << 16) + startEdge;
-	  i += 3;
-	  startEdge = edge;
-	  if (!t.srcTarg(source, edge, edgesRead++)) {
-	    return;
+	  break;
+	case 3:
+	  for(uint j = 0; j < runlength; j++) {
+	    uintE edge = (uintE) start[i] + (((uintE) start[i+1]) << 8) + (((uintE) start[i+2]) << 16) + startEdge;
+	    i += 3;
+	    startEdge = edge;
+	    if (!t.srcTarg(source, edge, edgesRead++)) {
+	      return;
+	    }
 	  }
-	}
-	break;
-      default:
-	for(uint j = 0; j < runlength; j++) {
-	  uintE edge = (uintE) start[i] + (((uintE) start[i+1]) << 8) + (((uintE) start[i+2]) << 16) + (((uintE) start[i+3]) << 24) + startEdge;
-	  i+=4;
-	  startEdge = edge;
-	  if (!t.srcTarg(source, edge, edgesRead++)) {
-	    return;
+	  break;
+	default:
+	  for(uint j = 0; j < runlength; j++) {
+	    uintE edge = (uintE) start[i] + (((uintE) start[i+1]) << 8) + (((uintE) start[i+2]) << 16) + (((uintE) start[i+3]) << 24) + startEdge;
+	    i+=4;
+	    startEdge = edge;
+	    if (!t.srcTarg(source, edge, edgesRead++)) {
+	      return;
+	    }
 	  }
 	}
       }
     }
 
     //do remaining chunks in parallel
-    {granular_for(k, 1, numChunks, par, {
+    {granular_for(k, max(1L,chunkLo), min(numChunks,chunkHi), par, {
       long o = k*PARALLEL_DEGREE;
       long end = o+min<long>(PARALLEL_DEGREE,degree-o);
 
@@ -461,7 +465,8 @@ int numBytesSigned (intE x) {
 }
 
 template <class T>
-  inline void decodeWgh(T t, uchar* edgeStart, const uintE &source, const uintT &degree, const bool par=true) {
+  inline void decodeWgh(T t, uchar* edgeStart, const uintE &source, const uintT &degree, const bool par=true,
+                     long chunkLo=0, long chunkHi=LONG_MAX) {
   if (degree > 0) {
     uintE edgesRead = 0;
     long numChunks = 1+(degree-1)/PARALLEL_DEGREE;
@@ -469,122 +474,124 @@ template <class T>
     uchar* start = edgeStart+(numChunks-1)*sizeof(uintE);
     long end = min<long>(PARALLEL_DEGREE,degree);
 
-    // Eat first edge, which is compressed specially
-    uintE startEdge = eatFirstEdge(start,source);
-    intE weight = eatWeight(start);
-    if (!t.srcTarg(source,startEdge, weight, edgesRead)) {
-      return;
-    }
-    uintT i = 0;
-    edgesRead = 1;
-    while(1) {
-      if(edgesRead == end) break;
-      uchar header = start[i++];
-      uint info = header & 0x7; //3 bits for info
-      uint runlength = 1 + (header >> 3);
-      switch(info) {
-      case 0:
-	for(uint j = 0; j < runlength; j++) {
-	  uintE edge = (uintE) start[i] + startEdge;
-	  startEdge = edge;
-	  uintE w = start[i+1]; //highest bit is sign bit
-	  intE weight = (w & 0x80) ? -(w & 0x7f) : (w & 0x7f);
-	  i+=2;
-	  if (!t.srcTarg(source, edge, weight, edgesRead++)) {
-	    return;
+    if (chunkLo == 0) {
+      // Eat first edge, which is compressed specially
+      uintE startEdge = eatFirstEdge(start,source);
+      intE weight = eatWeight(start);
+      if (!t.srcTarg(source,startEdge, weight, edgesRead)) {
+	return;
+      }
+      uintT i = 0;
+      edgesRead = 1;
+      while(1) {
+	if(edgesRead == end) break;
+	uchar header = start[i++];
+	uint info = header & 0x7; //3 bits for info
+	uint runlength = 1 + (header >> 3);
+	switch(info) {
+	case 0:
+	  for(uint j = 0; j < runlength; j++) {
+	    uintE edge = (uintE) start[i] + startEdge;
+	    startEdge = edge;
+	    uintE w = start[i+1]; //highest bit is sign bit
+	    intE weight = (w & 0x80) ? -(w & 0x7f) : (w & 0x7f);
+	    i+=2;
+	    if (!t.srcTarg(source, edge, weight, edgesRead++)) {
+	      return;
+	    }
 	  }
-	}
-	break;
-      case 1:
-	for(uint j = 0; j < runlength; j++) {
-	  uintE edge = (uintE) start[i] + (((uintE) start[i+1]) << 8) + startEdge;
-	  startEdge = edge;
-	  uintE w = start[i+2]; //highest bit is sign bit
-	  intE weight = (w & 0x80) ? -(w & 0x7f) : (w & 0x7f);
-	  i += 3;
-	  if (!t.srcTarg(source, edge, weight, edgesRead++)) {
-	    return;
+	  break;
+	case 1:
+	  for(uint j = 0; j < runlength; j++) {
+	    uintE edge = (uintE) start[i] + (((uintE) start[i+1]) << 8) + startEdge;
+	    startEdge = edge;
+	    uintE w = start[i+2]; //highest bit is sign bit
+	    intE weight = (w & 0x80) ? -(w & 0x7f) : (w & 0x7f);
+	    i += 3;
+	    if (!t.srcTarg(source, edge, weight, edgesRead++)) {
+	      return;
+	    }
 	  }
-	}
-	break;
-      case 2:
-	for(uint j = 0; j < runlength; j++) {
-	  uintE edge = (uintE) start[i] + (((uintE) start[i+1]) << 8) + (((uintE) start[i+2]) << 16) + startEdge;
-	  startEdge = edge;
-	  uintE w = start[i+3]; //highest bit is sign bit
-	  intE weight = (w & 0x80) ? -(w & 0x7f) : (w & 0x7f);
-	  i+=4;
-	  if (!t.srcTarg(source, edge, weight, edgesRead++)) {
-	    return;
+	  break;
+	case 2:
+	  for(uint j = 0; j < runlength; j++) {
+	    uintE edge = (uintE) start[i] + (((uintE) start[i+1]) << 8) + (((uintE) start[i+2]) << 16) + startEdge;
+	    startEdge = edge;
+	    uintE w = start[i+3]; //highest bit is sign bit
+	    intE weight = (w & 0x80) ? -(w & 0x7f) : (w & 0x7f);
+	    i+=4;
+	    if (!t.srcTarg(source, edge, weight, edgesRead++)) {
+	      return;
+	    }
 	  }
-	}
-	break;
-      case 3:
-	for(uint j = 0; j < runlength; j++) {
-	  uintE edge = (uintE) start[i] + (((uintE) start[i+1]) << 8) + (((uintE) start[i+2]) << 16) + (((uintE) start[i+3]) << 24) + startEdge;
-	  startEdge = edge;
-	  uintE w = start[i+4]; //highest bit is sign bit
-	  intE weight = (w & 0x80) ? -(w & 0x7f) : (w & 0x7f);
-	  i+=5;
-	  if (!t.srcTarg(source, edge, weight, edgesRead++)) {
-	    return;
+	  break;
+	case 3:
+	  for(uint j = 0; j < runlength; j++) {
+	    uintE edge = (uintE) start[i] + (((uintE) start[i+1]) << 8) + (((uintE) start[i+2]) << 16) + (((uintE) start[i+3]) << 24) + startEdge;
+	    startEdge = edge;
+	    uintE w = start[i+4]; //highest bit is sign bit
+	    intE weight = (w & 0x80) ? -(w & 0x7f) : (w & 0x7f);
+	    i+=5;
+	    if (!t.srcTarg(source, edge, weight, edgesRead++)) {
+	      return;
+	    }
 	  }
-	}
-	break;
-      case 4:
-	for(uint j = 0; j < runlength; j++) {
-	  uintE edge = (uintE) start[i] + startEdge;
-	  startEdge = edge;
-	  uintE w = start[i+1]; //highest bit is sign bit
-	  intE weight = (w & 0x7f) + (((uintE) start[i+2]) << 7) + (((uintE) start[i+3]) << 15)  + (((uintE) start[i+4]) << 23);
-	  if(w & 0x80) weight = -weight;
-	  i+=5;
-	  if (!t.srcTarg(source, edge, weight, edgesRead++)) {
-	    return;
+	  break;
+	case 4:
+	  for(uint j = 0; j < runlength; j++) {
+	    uintE edge = (uintE) start[i] + startEdge;
+	    startEdge = edge;
+	    uintE w = start[i+1]; //highest bit is sign bit
+	    intE weight = (w & 0x7f) + (((uintE) start[i+2]) << 7) + (((uintE) start[i+3]) << 15)  + (((uintE) start[i+4]) << 23);
+	    if(w & 0x80) weight = -weight;
+	    i+=5;
+	    if (!t.srcTarg(source, edge, weight, edgesRead++)) {
+	      return;
+	    }
 	  }
-	}
-	break;
-      case 5:
-	for(uint j = 0; j < runlength; j++) {
-	  uintE edge = (uintE) start[i] + (((uintE) start[i+1]) << 8) + startEdge;
-	  startEdge = edge;
-	  uintE w = start[i+2]; //highest bit is sign bit
-	  intE weight = (w & 0x7f) + (((uintE) start[i+3]) << 7) + (((uintE) start[i+4]) << 15)  + (((uintE) start[i+5]) << 23);
-	  if(w & 0x80) weight = -weight;
-	  i+=6;
-	  if (!t.srcTarg(source, edge, weight, edgesRead++)) {
-	    return;
+	  break;
+	case 5:
+	  for(uint j = 0; j < runlength; j++) {
+	    uintE edge = (uintE) start[i] + (((uintE) start[i+1]) << 8) + startEdge;
+	    startEdge = edge;
+	    uintE w = start[i+2]; //highest bit is sign bit
+	    intE weight = (w & 0x7f) + (((uintE) start[i+3]) << 7) + (((uintE) start[i+4]) << 15)  + (((uintE) start[i+5]) << 23);
+	    if(w & 0x80) weight = -weight;
+	    i+=6;
+	    if (!t.srcTarg(source, edge, weight, edgesRead++)) {
+	      return;
+	    }
 	  }
-	}
-	break;
-      case 6:
-	for(uint j = 0; j < runlength; j++) {
-	  uintE edge = (uintE) start[i] + (((uintE) start[i+1]) << 8) + (((uintE) start[i+2]) << 16) + startEdge;
-	  startEdge = edge;
-	  uintE w = start[i+3]; //highest bit is sign bit
-	  intE weight = (w & 0x7f) + (((uintE) start[i+4]) << 7) + (((uintE) start[i+5]) << 15)  + (((uintE) start[i+6]) << 23);
-	  if(w & 0x80) weight = -weight;
-	  i+=7;
-	  if (!t.srcTarg(source, edge, weight, edgesRead++)) {
-	    return;
+	  break;
+	case 6:
+	  for(uint j = 0; j < runlength; j++) {
+	    uintE edge = (uintE) start[i] + (((uintE) start[i+1]) << 8) + (((uintE) start[i+2]) << 16) + startEdge;
+	    startEdge = edge;
+	    uintE w = start[i+3]; //highest bit is sign bit
+	    intE weight = (w & 0x7f) + (((uintE) start[i+4]) << 7) + (((uintE) start[i+5]) << 15)  + (((uintE) start[i+6]) << 23);
+	    if(w & 0x80) weight = -weight;
+	    i+=7;
+	    if (!t.srcTarg(source, edge, weight, edgesRead++)) {
+	      return;
+	    }
 	  }
-	}
-      default:
-	for(uint j = 0; j < runlength; j++) {
-	  uintE edge = (uintE) start[i] + (((uintE) start[i+1]) << 8) + (((uintE) start[i+2]) << 16) + (((uintE) start[i+3]) << 24) + startEdge;
-	  startEdge = edge;
-	  uintE w = start[i+4]; //highest bit is sign bit
-	  intE weight = (w & 0x7f) + (((uintE) start[i+5]) << 7) + (((uintE) start[i+6]) << 15)  + (((uintE) start[i+7]) << 23);
-	  if(w & 0x80) weight = -weight;
-	  i+=8;
-	  if (!t.srcTarg(source, edge, weight, edgesRead++)) {
-	    return;
+	default:
+	  for(uint j = 0; j < runlength; j++) {
+	    uintE edge = (uintE) start[i] + (((uintE) start[i+1]) << 8) + (((uintE) start[i+2]) << 16) + (((uintE) start[i+3]) << 24) + startEdge;
+	    startEdge = edge;
+	    uintE w = start[i+4]; //highest bit is sign bit
+	    intE weight = (w & 0x7f) + (((uintE) start[i+5]) << 7) + (((uintE) start[i+6]) << 15)  + (((uintE) start[i+7]) << 23);
+	    if(w & 0x80) weight = -weight;
+	    i+=8;
+	    if (!t.srcTarg(source, edge, weight, edgesRead++)) {
+	      return;
+	    }
 	  }
 	}
       }
     }
 
-    {granular_for(k, 1, numChunks, par, {
+    {granular_for(k, max(1L,chunkLo), min(numChunks,chunkHi), par, {
       long o = k*PARALLEL_DEGREE;
       long end = o+min<long>(PARALLEL_DEGREE,degree-o);
       uchar* myStart = edgeStart + pOffsets[k-1];
@@ -193,6 +193,37 @@ namespace decode_compressed {
 #endif
   }
 
+  // Out-edges an edgeMapSparse task may take from a high-degree vertex
+  // must start at a multiple of this (0: the list cannot be split). With
+  // PD the lists are stored as independently decodable chunks.
+#ifdef PD
+  const long outSplitUnit = PARALLEL_DEGREE;
+#else
+  const long outSplitUnit = 0;
+#endif
+
+  // Like decodeOutNghSparse, but sequentially and only for the out-edges
+  // [lo, hi), where lo is a multiple of outSplitUnit and hi is one or the
+  // degree.
+  template <class V, class F, class G>
+  inline void decodeOutNghSparseRange(V* v, long i, uintT o, uintT lo, uintT hi, F &f, G &g) {
+    uchar *nghArr = v->getOutNeighbors();
+#ifdef PD
+    long chunkLo = lo / PARALLEL_DEGREE, chunkHi = (hi + PARALLEL_DEGREE - 1) / PARALLEL_DEGREE;
+#ifdef WEIGHTED
+    decodeWgh(sparseT<F, G>(f, g, i, o), nghArr, i, v->getOutDegree(), false, chunkLo, chunkHi);
+#else
+    decode(sparseT<F, G>(f, g, i, o), nghArr, i, v->getOutDegree(), false, chunkLo, chunkHi);
+#endif
+#else
+#ifdef WEIGHTED
+    decodeWgh(sparseT<F, G>(f, g, i, o), nghArr, i, v->getOutDegree(), false);
+#else
+    decode(sparseT<F, G>(f, g, i, o), nghArr, i, v->getOutDegree(), false);
+#endif
+#endif
+  }
+
   template <class V, class F, class G>
   inline size_t decodeOutNghSparseSeq(V* v, long i, uintT o, F &f, G &g) {
     uchar *nghArr = v->getOutNeighbors();
@@ -281,12 +312,14 @@ struct compressedSymmetricVertex {
   void del() {}
 
 
-  template<class VS, class F, class G>
+  // pf is accepted for uniformity with the uncompressed vertices and ignored:
+  // neighbors only become known as the byte stream is decoded.
+  template<long pf = 0, class VS, class F, class G>
   inline void decodeInNghBreakEarly(long i, VS& vertexSubset, F &f, G &g, bool parallel = 0) {
     decode_compressed::decodeInNghBreakEarly<compressedSymmetricVertex, F, G, VS>(this, i, vertexSubset, f, g, parallel);
   }
 
-  template<class F, class G>
+  template<long pf = 0, class F, class G>
   inline void decodeOutNgh(long i, F &f, G &g) {
     decode_compressed::decodeOutNgh<compressedSymmetricVertex, F, G>(this, i, f, g);
   }
@@ -301,6 +334,13 @@ struct compressedSymmetricVertex {
     return decode_compressed::decodeOutNghSparseSeq<compressedSymmetricVertex, F, G>(this, i, o, f, g);
   }
 
+  static long outSplitUnit() { return decode_compressed::outSplitUnit; }
+
+  template <class F, class G>
+  inline void decodeOutNghSparseRange(long i, uintT o, uintT lo, uintT hi, F &f, G &g) {
+    decode_compressed::decodeOutNghSparseRange<compressedSymmetricVertex, F, G>(this, i, o, lo, hi, f, g);
+  }
+
   template <class E, class F, class G>
   inline void copyOutNgh(long i, uintT o, F& f, G& g) {
     decode_compressed::copyOutNgh<compressedSymmetricVertex, E, F, G>(this, i, o, f, g);
@@ -343,12 +383,14 @@ struct compressedAsymmetricVertex {
     swap(inDegree,outDegree); }
   void del() {}
 
-  template<class VS, class F, class G>
+  // pf is accepted for uniformity with the uncompressed vertices and ignored:
+  // neighbors only become known as the byte stream is decoded.
+  template<long pf = 0, class VS, class F, class G>
   inline void decodeInNghBreakEarly(long i, VS& vertexSubset, F &f, G &g, bool parallel = 0) {
     decode_compressed::decodeInNghBreakEarly<compressedAsymmetricVertex, F, G, VS>(this, i, vertexSubset, f, g, parallel);
   }
 
-  template<class F, class G>
+  template<long pf = 0, class F, class G>
   inline void decodeOutNgh(long i, F &f, G &g) {
     decode_compressed::decodeOutNgh<compressedAsymmetricVertex, F, G>(this, i, f, g);
   }
@@ -363,6 +405,13 @@ struct compressedAsymmetricVertex {
     return decode_compressed::decodeOutNghSparseSeq<compressedAsymmetricVertex, F, G>(this, i, o, f, g);
   }
 
+  static long outSplitUnit() { return decode_compressed::outSplitUnit; }
+
+  template <class F, class G>
+  inline void decodeOutNghSparseRange(long i, uintT o, uintT lo, uintT hi, F &f, G &g) {
+    decode_compressed::decodeOutNghSparseRange<compressedAsymmetricVertex, F, G>(this, i, o, lo, hi, f, g);
+  }
+
   template <class E, class F, class G>
   inline void copyOutNgh(long i, uintT o, F& f, G& g) {
     decode_compressed::copyOutNgh<compressedAsymmetricVertex, E, F, G>(this, i, o, f, g);
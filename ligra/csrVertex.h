@@ -0,0 +1,233 @@
+// Vertex types for uncompressed graphs stored as plain CSR, selected by
+// compiling with -DCSR (see parallel_main in ligra.h). The vertex array is
+// the offsets array itself, kept as 64-bit pointers into the edge array:
+// element i holds where the edges of vertex i start, and they end where
+// those of vertex i+1 start, so the array has one extra element past n-1.
+// That is 8 bytes per vertex (16 for asymmetric graphs) instead of 16 (24)
+// for symmetricVertex (asymmetricVertex), with the same interface, so the
+// edgeMap templates run on it unchanged.
+//
+// Since a degree is read from the next element, a csr vertex is only
+// meaningful inside its array and cannot be copied out of it (the copy
+// constructor is deleted). Code that keeps vertices elsewhere, like the
+// frontier gathered by the sparse edgeMaps, goes through vertexView, which
+// turns a csr vertex into the equivalent symmetricVertex or
+// asymmetricVertex. Degrees cannot change, so edgeMapFilter's pack_edges is
+// not supported on csr graphs.
+#ifndef CSR_VERTEX_H
+#define CSR_VERTEX_H
+#include <iostream>
+#include <stdlib.h>
+#include "vertex.h"
+
+#ifndef WEIGHTED
+#define CSR_EDGE uintE
+#define CSR_STRIDE 1
+#else
+// weights are stored in the entry after the neighbor ID
+#define CSR_EDGE intE
+#define CSR_STRIDE 2
+#endif
+
+inline void csrNoPack() {
+  std::cout << "pack_edges is not supported on csr graphs" << std::endl;
+  abort();
+}
+
+struct csrSymmetricVertex {
+  CSR_EDGE* neighbors;
+  csrSymmetricVertex(const csrSymmetricVertex&) = delete;
+  csrSymmetricVertex& operator=(const csrSymmetricVertex&) = default;
+  void del() {}
+
+  CSR_EDGE* getInNeighbors () { return neighbors; }
+  const CSR_EDGE* getInNeighbors () const { return neighbors; }
+  CSR_EDGE* getOutNeighbors () { return neighbors; }
+  const CSR_EDGE* getOutNeighbors () const { return neighbors; }
+  CSR_EDGE getInNeighbor(uintT j) const { return neighbors[CSR_STRIDE*j]; }
+  CSR_EDGE getOutNeighbor(uintT j) const { return neighbors[CSR_STRIDE*j]; }
+  void setInNeighbor(uintT j, uintE ngh) { neighbors[CSR_STRIDE*j] = ngh; }
+  void setOutNeighbor(uintT j, uintE ngh) { neighbors[CSR_STRIDE*j] = ngh; }
+#ifdef WEIGHTED
+  intE getInWeight(uintT j) const { return neighbors[2*j+1]; }
+  intE getOutWeight(uintT j) const { return neighbors[2*j+1]; }
+  void setInWeight(uintT j, intE wgh) { neighbors[2*j+1] = wgh; }
+  void setOutWeight(uintT j, intE wgh) { neighbors[2*j+1] = wgh; }
+#endif
+
+  uintT getInDegree() const { return ((this+1)->neighbors - neighbors) / CSR_STRIDE; }
+  uintT getOutDegree() const { return getInDegree(); }
+  void flipEdges() {}
+
+  template <long pf = 0, class VS, class F, class G>
+  inline void decodeInNghBreakEarly(long v_id, VS& vertexSubset, F &f, G &g, bool parallel = 0) {
+    decode_uncompressed::decodeInNghBreakEarly<pf, csrSymmetricVertex, F, G, VS>(this, v_id, vertexSubset, f, g, parallel);
+  }
+
+  template <long pf = 0, class F, class G>
+  inline void decodeOutNgh(long i, F &f, G& g) {
+    decode_uncompressed::decodeOutNgh<pf, csrSymmetricVertex, F, G>(this, i, f, g);
+  }
+
+  template <class F, class G>
+  inline void decodeOutNghSparse(long i, uintT o, F &f, G &g) {
+    decode_uncompressed::decodeOutNghSparse<csrSymmetricVertex, F>(this, i, o, f, g);
+  }
+
+  template <class F, class G>
+  inline size_t decodeOutNghSparseSeq(long i, uintT o, F &f, G &g) {
+    return decode_uncompressed::decodeOutNghSparseSeq<csrSymmetricVertex, F>(this, i, o, f, g);
+  }
+
+  static long outSplitUnit() { return decode_uncompressed::outSplitUnit; }
+
+  template <class F, class G>
+  inline void decodeOutNghSparseRange(long i, uintT o, uintT lo, uintT hi, F &f, G &g) {
+    decode_uncompressed::decodeOutNghSparseRange<csrSymmetricVertex, F>(this, i, o, lo, hi, f, g);
+  }
+
+  template <class E, class F, class G>
+  inline void copyOutNgh(long i, uintT o, F& f, G& g) {
+    decode_uncompressed::copyOutNgh<csrSymmetricVertex, E>(this, i, o, f, g);
+  }
+
+  template <class F>
+  inline size_t countOutNgh(long i, F &f) {
+    return decode_uncompressed::countOutNgh<csrSymmetricVertex, F>(this, i, f);
+  }
+
+  template <class F>
+  inline size_t packOutNgh(long i, F &f, bool* bits, uintE* tmp1, uintE* tmp2) {
+    csrNoPack();
+    return 0;
+  }
+};
+
+struct csrAsymmetricVertex {
+  CSR_EDGE* inNeighbors, *outNeighbors;
+  csrAsymmetricVertex(const csrAsymmetricVertex&) = delete;
+  csrAsymmetricVertex& operator=(const csrAsymmetricVertex&) = default;
+  void del() {}
+
+  CSR_EDGE* getInNeighbors () { return inNeighbors; }
+  const CSR_EDGE* getInNeighbors () const { return inNeighbors; }
+  CSR_EDGE* getOutNeighbors () { return outNeighbors; }
+  const CSR_EDGE* getOutNeighbors () const { return outNeighbors; }
+  CSR_EDGE getInNeighbor(uintT j) const { return inNeighbors[CSR_STRIDE*j]; }
+  CSR_EDGE getOutNeighbor(uintT j) const { return outNeighbors[CSR_STRIDE*j]; }
+  void setInNeighbor(uintT j, uintE ngh) { inNeighbors[CSR_STRIDE*j] = ngh; }
+  void setOutNeighbor(uintT j, uintE ngh) { outNeighbors[CSR_STRIDE*j] = ngh; }
+#ifdef WEIGHTED
+  intE getInWeight(uintT j) const { return inNeighbors[2*j+1]; }
+  intE getOutWeight(uintT j) const { return outNeighbors[2*j+1]; }
+  void setInWeight(uintT j, intE wgh) { inNeighbors[2*j+1] = wgh; }
+  void setOutWeight(uintT j, intE wgh) { outNeighbors[2*j+1] = wgh; }
+#endif
+
+  uintT getInDegree() const { return ((this+1)->inNeighbors - inNeighbors) / CSR_STRIDE; }
+  uintT getOutDegree() const { return ((this+1)->outNeighbors - outNeighbors) / CSR_STRIDE; }
+  // graph::transpose flips every element, including the one past n-1.
+  void flipEdges() { swap(inNeighbors, outNeighbors); }
+
+  template <long pf = 0, class VS, class F, class G>
+  inline void decodeInNghBreakEarly(long v_id, VS& vertexSubset, F &f, G &g, bool parallel = 0) {
+    decode_uncompressed::decodeInNghBreakEarly<pf, csrAsymmetricVertex, F, G, VS>(this, v_id, vertexSubset, f, g, parallel);
+  }
+
+  template <long pf = 0, class F, class G>
+  inline void decodeOutNgh(long i, F &f, G &g) {
+    decode_uncompressed::decodeOutNgh<pf, csrAsymmetricVertex, F, G>(this, i, f, g);
+  }
+
+  template <class F, class G>
+  inline void decodeOutNghSparse(long i, uintT o, F &f, G &g) {
+    decode_uncompressed::decodeOutNghSparse<csrAsymmetricVertex, F>(this, i, o, f, g);
+  }
+
+  template <class F, class G>
+  inline size_t decodeOutNghSparseSeq(long i, uintT o, F &f, G &g) {
+    return decode_uncompressed::decodeOutNghSparseSeq<csrAsymmetricVertex, F>(this, i, o, f, g);
+  }
+
+  static long outSplitUnit() { return decode_uncompressed::outSplitUnit; }
+
+  template <class F, class G>
+  inline void decodeOutNghSparseRange(long i, uintT o, uintT lo, uintT hi, F &f, G &g) {
+    decode_uncompressed::decodeOutNghSparseRange<csrAsymmetricVertex, F>(this, i, o, lo, hi, f, g);
+  }
+
+  template <class E, class F, class G>
+  inline void copyOutNgh(long i, uintT o, F& f, G& g) {
+    decode_uncompressed::copyOutNgh<csrAsymmetricVertex, E>(this, i, o, f, g);
+  }
+
+  template <class F>
+  inline size_t countOutNgh(long i, F &f) {
+    return decode_uncompressed::countOutNgh<csrAsymmetricVertex, F>(this, i, f);
+  }
+
+  template <class F>
+  inline size_t packOutNgh(long i, F &f, bool* bits, uintE* tmp1, uintE* tmp2) {
+    csrNoPack();
+    return 0;
+  }
+};
+
+// How a vertex is read outside the vertex array: type is what get returns,
+// and extra is the number of elements the array has past n-1.
+template <class vertex>
+struct vertexView {
+  typedef vertex type;
+  static const long extra = 0;
+  static inline const vertex& get(const vertex& v) { return v; }
+};
+
+template <>
+struct vertexView<csrSymmetricVertex> {
+  typedef symmetricVertex type;
+  static const long extra = 1;
+  static inline symmetricVertex get(const csrSymmetricVertex& v) {
+    return symmetricVertex((CSR_EDGE*)v.neighbors, v.getOutDegree());
+  }
+};
+
+template <>
+struct vertexView<csrAsymmetricVertex> {
+  typedef asymmetricVertex type;
+  static const long extra = 1;
+  static inline asymmetricVertex get(const csrAsymmetricVertex& v) {
+    return asymmetricVertex((CSR_EDGE*)v.inNeighbors, (CSR_EDGE*)v.outNeighbors,
+                            v.getInDegree(), v.getOutDegree());
+  }
+};
+
+// Points the out-edges (in-edges if in) of v[0..n-1] at the edges from
+// offsets, which hold m edges in all (2m entries if WEIGHTED).
+template <class vertex>
+inline void setEdges(vertex* v, long n, long m, uintT* offsets, CSR_EDGE* edges, bool in) {
+  parallel_for(long i = 0; i < n; i++) {
+    uintT o = offsets[i];
+    uintT l = ((i == n - 1) ? m : offsets[i + 1]) - o;
+    if (in) { v[i].setInDegree(l); v[i].setInNeighbors(edges + CSR_STRIDE * o); }
+    else { v[i].setOutDegree(l); v[i].setOutNeighbors(edges + CSR_STRIDE * o); }
+  }
+}
+
+inline void setEdges(csrSymmetricVertex* v, long n, long m, uintT* offsets, CSR_EDGE* edges, bool in) {
+  parallel_for(long i = 0; i < n; i++) v[i].neighbors = edges + CSR_STRIDE * offsets[i];
+  v[n].neighbors = edges + CSR_STRIDE * m;
+}
+
+inline void setEdges(csrAsymmetricVertex* v, long n, long m, uintT* offsets, CSR_EDGE* edges, bool in) {
+  if (in) {
+    parallel_for(long i = 0; i < n; i++) v[i].inNeighbors = edges + CSR_STRIDE * offsets[i];
+    v[n].inNeighbors = edges + CSR_STRIDE * m;
+  } else {
+    parallel_for(long i = 0; i < n; i++) v[i].outNeighbors = edges + CSR_STRIDE * offsets[i];
+    v[n].outNeighbors = edges + CSR_STRIDE * m;
+  }
+}
+
+#undef CSR_STRIDE
+#undef CSR_EDGE
+#endif
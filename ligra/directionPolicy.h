@@ -0,0 +1,79 @@
+// Policies that decide whether edgeMap runs sparse (push) or dense (pull).
+// A policy is any class with
+//
+//   bool needsOutDegrees();
+//   bool dense(const directionInfo& info);
+//
+// and is passed to edgeMap/edgeMapData in place of the threshold. edgeMap
+// only computes the out-degree sum of the frontier when needsOutDegrees()
+// is true; dense() is called once per edgeMap and may update the policy's
+// state, so a policy object should be created per traversal.
+#ifndef DIRECTION_POLICY_H
+#define DIRECTION_POLICY_H
+#include <algorithm>
+#include "parallel.h"
+using namespace std;
+
+struct directionInfo {
+  long n;           // number of vertices
+  long m;           // number of edges
+  long frontier;    // number of active vertices
+  long outDegrees;  // sum of out-degrees of the active vertices
+  bool hasDense;    // the frontier already has a dense representation
+  bool hasSparse;   // the frontier already has a sparse representation
+};
+
+// The original Ligra rule: go dense when the frontier plus its out-edges
+// exceed threshold (m/20 by default). A threshold <= 0 always goes dense.
+struct thresholdPolicy {
+  long threshold;
+  thresholdPolicy(long _threshold) : threshold(_threshold) {}
+  bool needsOutDegrees() { return threshold > 0; }
+  bool dense(const directionInfo& info) {
+    return info.frontier + info.outDegrees > threshold;
+  }
+};
+
+// Direction-optimizing policy of Beamer, Asanovic and Patterson (SC'12) for
+// traversals in which every vertex becomes active at most once (BFS, the
+// forward phase of BC). It estimates the edges still unexplored (m_u) and
+// the vertices still unvisited (n_u) from the frontiers it has seen.
+//  - From sparse, switch to dense when the pull cost m_u/alpha is below the
+//    push cost m_f. Each side is charged conversionWeight*n if the frontier
+//    would first need toDense/toSparse.
+//  - Once dense, stay dense (hysteresis) until the frontier drops below
+//    n_u/beta.
+struct beamerPolicy {
+  double alpha, beta, conversionWeight;
+  long unexploredEdges, unvisitedVertices;
+  bool lastDense, started;
+
+  beamerPolicy(double _alpha = 14, double _beta = 24, double _conversionWeight = 0.125)
+    : alpha(_alpha), beta(_beta), conversionWeight(_conversionWeight),
+      unexploredEdges(0), unvisitedVertices(0), lastDense(0), started(0) {}
+
+  bool needsOutDegrees() { return true; }
+
+  bool dense(const directionInfo& info) {
+    if (!started) {
+      unexploredEdges = info.m;
+      unvisitedVertices = info.n;
+      started = 1;
+    }
+    bool d;
+    if (lastDense) {
+      d = info.frontier * beta >= unvisitedVertices;
+    } else {
+      double conversion = conversionWeight * info.n;
+      double pushCost = info.outDegrees + (info.hasSparse ? 0 : conversion);
+      double pullCost = unexploredEdges / alpha + (info.hasDense ? 0 : conversion);
+      d = pullCost < pushCost;
+    }
+    unexploredEdges = max(0L, unexploredEdges - info.outDegrees);
+    unvisitedVertices = max(0L, unvisitedVertices - info.frontier);
+    lastDense = d;
+    return d;
+  }
+};
+
+#endif
@@ -0,0 +1,153 @@
+// Asynchronous edgeMap. Instead of running rounds separated by barriers,
+// each worker repeatedly takes an active vertex from its own queue and
+// applies F to its out-edges; a destination for which updateAtomic returns
+// true is activated (queued, unless it already is) right away. Workers
+// steal from each other when their queue runs dry, and the call returns once
+// no vertex is queued or being processed. This suits label-correcting
+// algorithms (shortest paths, label propagation) whose updates are
+// monotone, so that the result does not depend on the processing order.
+//
+// F has the edgeMap interface, of which only cond and updateAtomic are
+// used. updateAtomic should return true iff it improved the destination;
+// the engine removes duplicate activations itself. Given a priority functor
+// (uintE v) -> K, each queue pops its vertex of smallest priority (taken
+// when v was activated) first; otherwise queues are FIFO.
+#pragma once
+
+#include <deque>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include "ligra.h"
+
+// Stands in for the priority functor of an unordered edgeMapAsync.
+struct noPriority {};
+
+// Queues of the workers of edgeMapAsync: a binary min-heap on the priority,
+// or a FIFO without one.
+template <class K>
+struct asyncHeap {
+  typedef pair<K, uintE> E;
+  vector<E> h;
+  inline void push(K k, uintE v) {
+    h.push_back(make_pair(k, v));
+    push_heap(h.begin(), h.end(), greater<E>());
+  }
+  inline bool pop(uintE& v) {
+    if (h.empty()) return false;
+    pop_heap(h.begin(), h.end(), greater<E>());
+    v = h.back().second;
+    h.pop_back();
+    return true;
+  }
+};
+
+struct asyncFifo {
+  deque<uintE> q;
+  inline bool pop(uintE& v) {
+    if (q.empty()) return false;
+    v = q.front();
+    q.pop_front();
+    return true;
+  }
+};
+
+template <class P>
+struct asyncOrder {
+  typedef decltype(declval<P&>()((uintE)0)) K;
+  typedef asyncHeap<K> Q;
+  static inline void push(Q& q, P& p, uintE v) { q.push(p(v), v); }
+};
+
+template <>
+struct asyncOrder<noPriority> {
+  typedef asyncFifo Q;
+  static inline void push(Q& q, noPriority& p, uintE v) { q.q.push_back(v); }
+};
+
+// A worker's queue behind a spinlock (other workers steal from it).
+template <class Q>
+struct asyncWorker {
+  Q q;
+  volatile int lock;
+  long processed;
+  char pad[64]; // keeps workers' locks on separate cache lines
+  asyncWorker() : lock(0), processed(0) {}
+  inline void acquire() {
+    while (__sync_lock_test_and_set(&lock, 1)) while (lock);
+  }
+  inline void release() { __sync_lock_release(&lock); }
+  template <class P>
+  inline void push(P& p, uintE v) {
+    acquire(); asyncOrder<P>::push(q, p, v); release();
+  }
+  inline bool pop(uintE& v) {
+    acquire(); bool r = q.pop(v); release();
+    return r;
+  }
+};
+
+// Runs F from the vertices of vs until no vertex is active, and returns the
+// number of vertices processed (a vertex counts once per activation). Stops
+// early, returning a value above maxActivations, once more than
+// maxActivations vertices have been processed; callers use this to bound
+// runs that need not converge (e.g. negative cycles).
+template <class vertex, class VS, class F, class P = noPriority>
+long edgeMapAsync(graph<vertex>& GA, VS& vs, F f, P prio = P(),
+                  long maxActivations = LONG_MAX) {
+  typedef asyncWorker<typename asyncOrder<P>::Q> W;
+  vertex* G = GA.V;
+  // The queued flags borrow the graph's dedup bitmap, which is all zero
+  // between calls; every queued vertex is popped (clearing its bit) unless
+  // the run stops early.
+  uint64_t* queued = GA.getDedupBits();
+  int workers = getWorkers();
+  W* ws = new W[workers];
+  long pending = 0;   // vertices queued or being processed
+  long processed = 0; // published in batches by the workers
+  volatile bool stop = false;
+
+  vs.toSparse();
+  size_t seeds = vs.size();
+  parallel_for_1(int w = 0; w < workers; w++) {
+    long k = 0;
+    for (size_t i = (seeds * w) / workers; i < (seeds * (w + 1)) / workers; i++) {
+      uintE v = vs.vtx(i);
+      if (bitmapTestAndSet(queued, v)) { asyncOrder<P>::push(ws[w].q, prio, v); k++; }
+    }
+    __sync_fetch_and_add(&pending, k);
+  }
+
+  parallel_for_1(int w = 0; w < workers; w++) {
+    W& me = ws[w];
+    auto g = [&] (uintE ngh, uintT offset, bool m = false) {
+      if (m && bitmapTestAndSet(queued, ngh)) {
+        __sync_fetch_and_add(&pending, 1L);
+        me.push(prio, ngh);
+      }
+      return false;
+    };
+    long batch = 0;
+    while (__atomic_load_n(&pending, __ATOMIC_ACQUIRE) > 0 && !stop) {
+      uintE v;
+      bool found = me.pop(v);
+      for (int i = 1; !found && i < workers; i++) found = ws[(w + i) % workers].pop(v);
+      if (!found) continue;
+      bitmapClearAtomic(queued, v); // a later improvement of v requeues it
+      G[v].decodeOutNghSparseSeq(v, 0, f, g);
+      __sync_fetch_and_add(&pending, -1L);
+      if (++batch == 1024) {
+        if (__sync_add_and_fetch(&processed, batch) > maxActivations) stop = true;
+        batch = 0;
+      }
+    }
+    me.processed = batch;
+  }
+  for (int w = 0; w < workers; w++) processed += ws[w].processed;
+  if (stop) {
+    size_t nw = bitmapWords(GA.n);
+    parallel_for(size_t i = 0; i < nw; i++) queued[i] = 0;
+  }
+  delete[] ws;
+  return processed;
+}
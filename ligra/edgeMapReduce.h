@@ -13,7 +13,7 @@ inline vertexSubsetData<E> edgeMapInduced(graph<vertex>& GA, VS& V, F& f) {
   V.toSparse();
   auto degrees = array_imap<uintT>(m);
   granular_for(i, 0, m, (m > 2000), {
-    vertex v = G[V.vtx(i)];
+    vertex& v = G[V.vtx(i)];
     uintE degree = v.getOutDegree();
     degrees[i] = degree;
   });
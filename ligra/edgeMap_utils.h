@@ -38,6 +38,58 @@ auto get_emdense_forward_gen(tuple<bool, data>* next) {
     if (m.exists) next[ngh] = make_tuple(1, m.t); };
 }
 
+// Bitmap version of edgeMapDense and edgeMapDenseForward (dense_bitmap).
+// Neighboring vertices share a word, so bits are set atomically.
+inline auto get_emdense_bits_gen(uint64_t* next) {
+  return [next] (uintE ngh, bool m=false) {
+    if (m) bitmapSetAtomic(next, ngh); };
+}
+
+// Wraps the edgeMap functor for dense_block_skip. cond fails for every
+// destination in a 64-vertex group whose in-neighbor blocks (inBlockMasks,
+// see graph.h) miss the frontier's summary fold, so those destinations are
+// skipped without touching their edges.
+template <class F>
+struct blockSkipF {
+  F& f;
+  const uint64_t* inBlockMasks;
+  uint64_t fold;
+  blockSkipF(F& _f, const uint64_t* _inBlockMasks, uint64_t _fold)
+    : f(_f), inBlockMasks(_inBlockMasks), fold(_fold) {}
+  template <class... Args>
+  inline auto update(Args... args) { return f.update(args...); }
+  template <class... Args>
+  inline auto updateAtomic(Args... args) { return f.updateAtomic(args...); }
+  inline bool cond(uintE d) { return (inBlockMasks[d >> 6] & fold) && f.cond(d); }
+  inline void prefetchSource(uintE s) { ::prefetchSource(f, s, 0); }
+};
+
+// Whether the value passed to a gen-function records a successful update.
+inline bool emExists(bool m) { return m; }
+template <class data>
+inline bool emExists(const Maybe<data>& m) { return m.exists; }
+
+// Wraps the gen-function of a sparse edgeMap under dedup_bitmap: an update
+// reaches g only if it is the first to set its destination's bit, and the
+// others are passed on as failed updates.
+template <class G>
+struct dedupGen {
+  G g;
+  uint64_t* bits;
+  dedupGen(G _g, uint64_t* _bits) : g(_g), bits(_bits) {}
+  inline auto operator () (uintE ngh, uintT offset) { return g(ngh, offset); }
+  template <class M>
+  inline auto operator () (uintE ngh, uintT offset, M m) {
+    if (emExists(m) && !bitmapTestAndSet(bits, ngh)) return g(ngh, offset, M());
+    return g(ngh, offset, m);
+  }
+};
+
+template <class G>
+inline dedupGen<G> get_emsparse_dedup_gen(G g, uint64_t* bits) {
+  return dedupGen<G>(g, bits);
+}
+
 // Standard version of edgeMapSparse.
 template <typename data, typename std::enable_if<
   std::is_same<data, pbbs::empty>::value, int>::type=0 >
@@ -63,6 +115,27 @@ auto get_emsparse_gen(tuple<uintE, data>* outEdges) {
   };
 }
 
+// edgeMapSparse_local
+// Version of edgeMapSparse that appends the next frontier to the calling
+// worker's buffer.
+template <typename data, typename std::enable_if<
+  std::is_same<data, pbbs::empty>::value, int>::type=0 >
+auto get_emsparse_local_gen(frontierPool::localBuffer* buf) {
+  return [buf] (uintE ngh, uintT offset, bool m=false) {
+    if (m) buf->push(make_tuple(ngh, pbbs::empty()));
+    return m;
+  };
+}
+
+template <typename data, typename std::enable_if<
+  !std::is_same<data, pbbs::empty>::value, int>::type=0 >
+auto get_emsparse_local_gen(frontierPool::localBuffer* buf) {
+  return [buf] (uintE ngh, uintT offset, Maybe<data> m=Maybe<data>()) {
+    if (m.exists) buf->push(make_tuple(ngh, m.t));
+    return m.exists;
+  };
+}
+
 // edgeMapSparse_no_filter
 // Version of edgeMapSparse that binary-searches and packs out blocks of the
 // next frontier.
@@ -0,0 +1,232 @@
+#ifndef FRONTIER_POOL_H
+#define FRONTIER_POOL_H
+#include <stdlib.h>
+#include <stdint.h>
+#include <tuple>
+#include <vector>
+#include <sys/mman.h>
+#include "parallel.h"
+#include "utils.h"
+using namespace std;
+
+// Set from the command line (-hugepool) before the graph is loaded. Pools
+// created afterwards back their buffers with 2MB pages when possible.
+static bool pool_huge_pages = false;
+
+// Graph-scoped workspace for edgeMap. The scratch slots hold the per-call
+// temporaries (frontier degrees and vertices, the unfiltered sparse output,
+// block counts, hub pieces) and are valid only for the duration of a single edgeMap. The
+// sparse, dense and bitmap slots are double-buffered and back the frontiers produced
+// by edgeMap when the reuse_frontier flag is passed: the output of round i
+// lives in parity i%2, so it stays valid while round i+1 reads it, and is
+// overwritten by round i+2. Buffers only grow, so steady-state rounds do no
+// allocation and touch no new pages. Dense and bitmap buffers filled from a
+// small sparse frontier remember the entries they set, so recycling them
+// clears only those rather than all n.
+struct frontierPool {
+  enum scratchSlot { degrees_slot, vertices_slot, edges_slot, packed_slot,
+                     blocks_slot, counts_slot, chunks_slot, pieces_slot, num_scratch };
+
+  struct buffer {
+    void* p;
+    size_t bytes;
+    buffer() : p(NULL), bytes(0) {}
+
+    // place is numa_partition for the dense and bitmap frontiers, which
+    // the dense edgeMaps write node by node under -numa.
+    void* reserve(size_t need, bool useHuge, numaMode place = numa_local) {
+      if (need <= bytes) return p;
+      release();
+      if (useHuge) p = pageAlloc(need, "frontierPool", page_huge_2m, place);
+      else if (place != numa_local && numaNodes() > 1)
+        p = pageAlloc(need, "frontierPool", page_policy, place);
+      else p = newA(char, need);
+      bytes = need;
+      return p;
+    }
+
+    void release() {
+      if (p == NULL) return;
+      pageFree(p);
+      p = NULL; bytes = 0;
+    }
+  };
+
+  // Output of one worker in edgeMapSparse_local: fixed-size chunks appended
+  // to in order, kept across calls.
+  static const size_t local_chunk_bytes = 1 << 16;
+  struct localBuffer {
+    vector<char*> chunks; // allocated chunks; the first used are in use
+    size_t used;
+    size_t fill;          // bytes written to the last chunk in use
+    char pad[64];         // keeps workers' counters on separate cache lines
+    localBuffer() : used(0), fill(0) {}
+
+    template <class T>
+    inline void push(const T& t) {
+      if (used == 0 || fill + sizeof(T) > local_chunk_bytes) {
+        if (used == chunks.size()) chunks.push_back(newA(char, local_chunk_bytes));
+        used++;
+        fill = 0;
+      }
+      *(T*)(chunks[used-1] + fill) = t;
+      fill += sizeof(T);
+    }
+
+    // Number of T's pushed since the last reset.
+    template <class T>
+    size_t size() const {
+      return used == 0 ? 0 : (used-1) * (local_chunk_bytes / sizeof(T)) + fill / sizeof(T);
+    }
+
+    void release() {
+      for (size_t i = 0; i < chunks.size(); i++) free(chunks[i]);
+      chunks.clear();
+      used = fill = 0;
+    }
+  };
+
+  // Entries of a dense or bitmap buffer that may be set: the k indices in
+  // idx, or any if all. Lets the buffer be cleared in O(k) when recycled.
+  struct dirtySet {
+    buffer idx;
+    size_t k;
+    size_t width; // entry size of the last clear
+    bool all;
+    dirtySet() : k(0), width(0), all(1) {}
+  };
+
+  // A recycled buffer is cleared entry by entry when at most 1/sparse_clear_ratio
+  // of it was set, and with a full parallel pass otherwise.
+  static const size_t sparse_clear_ratio = 16;
+
+  buffer scratch[num_scratch];
+  localBuffer* local;
+  int numLocal;
+  buffer sparse[2], dense[2], bits[2], summary[2];
+  dirtySet denseDirty[2], bitsDirty[2];
+  int cur; // parity of the most recently produced pooled frontier
+  bool hugepages;
+
+  frontierPool(bool _hugepages = pool_huge_pages)
+    : local(NULL), numLocal(0), cur(1), hugepages(_hugepages) {}
+
+  template <class T>
+  T* getScratch(scratchSlot slot, size_t n) {
+    return (T*)scratch[slot].reserve(n * sizeof(T), hugepages);
+  }
+
+  // Buffers for the representation of the current (input) frontier that
+  // toSparse/toDense/toBits/toSummary materialize.
+  template <class T>
+  T* curSparse(size_t n) { return (T*)sparse[cur].reserve(n * sizeof(T), hugepages); }
+  template <class T>
+  T* curDense(size_t n) {
+    denseDirty[cur].all = 1;
+    return (T*)dense[cur].reserve(n * sizeof(T), hugepages, numa_partition);
+  }
+  uint64_t* curBits(size_t words) {
+    bitsDirty[cur].all = 1;
+    return (uint64_t*)bits[cur].reserve(words * sizeof(uint64_t), hugepages, numa_partition);
+  }
+  uint64_t* curSummary(size_t words) {
+    return (uint64_t*)summary[cur].reserve(words * sizeof(uint64_t), hugepages);
+  }
+
+  // Like curDense, but with every entry false (the flag of a tuple<bool,
+  // data>). Only the entries recorded by markDense are reset if nothing else
+  // wrote to the buffer since.
+  template <class T>
+  T* curDenseClear(size_t n) {
+    dirtySet& ds = denseDirty[cur];
+    bool grew = dense[cur].bytes < n * sizeof(T);
+    T* d = (T*)dense[cur].reserve(n * sizeof(T), hugepages, numa_partition);
+    if (ds.all || grew || ds.width != sizeof(T)) {
+      parallel_for(size_t i = 0; i < n; i++) clearEntry(d[i]);
+    } else {
+      uintE* idx = (uintE*)ds.idx.p;
+      parallel_for(size_t i = 0; i < ds.k; i++) clearEntry(d[idx[i]]);
+    }
+    ds.k = 0; ds.all = 0; ds.width = sizeof(T);
+    return d;
+  }
+
+  // Like curBits, but all zero. See curDenseClear.
+  uint64_t* curBitsClear(size_t words) {
+    dirtySet& ds = bitsDirty[cur];
+    bool grew = bits[cur].bytes < words * sizeof(uint64_t);
+    uint64_t* b = (uint64_t*)bits[cur].reserve(words * sizeof(uint64_t), hugepages, numa_partition);
+    if (ds.all || grew) {
+      parallel_for(size_t w = 0; w < words; w++) b[w] = 0;
+    } else {
+      uintE* idx = (uintE*)ds.idx.p;
+      parallel_for(size_t i = 0; i < ds.k; i++) b[idx[i] >> 6] = 0;
+    }
+    ds.k = 0; ds.all = 0;
+    return b;
+  }
+
+  // Record that the entries get(0..m) of the buffer returned by the last
+  // curDenseClear (curBitsClear) of n entries were set.
+  template <class G>
+  void markDense(G get, size_t m, size_t n) { mark(denseDirty[cur], get, m, n); }
+  template <class G>
+  void markBits(G get, size_t m, size_t n) { mark(bitsDirty[cur], get, m, n); }
+
+  // Buffers for the frontier about to be produced. Call flip() once the
+  // output has been written.
+  template <class T>
+  T* nextSparse(size_t n) { return (T*)sparse[1-cur].reserve(n * sizeof(T), hugepages); }
+  template <class T>
+  T* nextDense(size_t n) {
+    denseDirty[1-cur].all = 1;
+    return (T*)dense[1-cur].reserve(n * sizeof(T), hugepages, numa_partition);
+  }
+  uint64_t* nextBits(size_t words) {
+    bitsDirty[1-cur].all = 1;
+    return (uint64_t*)bits[1-cur].reserve(words * sizeof(uint64_t), hugepages, numa_partition);
+  }
+
+  void flip() { cur = 1 - cur; }
+
+  // One empty localBuffer per worker.
+  localBuffer* getLocal(int workers) {
+    if (workers > numLocal) {
+      if (local != NULL) { releaseLocal(); delete[] local; }
+      local = new localBuffer[workers];
+      numLocal = workers;
+    }
+    for (int i = 0; i < numLocal; i++) local[i].used = local[i].fill = 0;
+    return local;
+  }
+
+  static inline void clearEntry(bool& b) { b = 0; }
+  template <class D>
+  static inline void clearEntry(tuple<bool, D>& t) { std::get<0>(t) = 0; }
+
+  template <class G>
+  void mark(dirtySet& ds, G get, size_t m, size_t n) {
+    if (ds.all) return;
+    if (ds.k != 0 || m * sparse_clear_ratio > n) { ds.all = 1; return; }
+    uintE* idx = (uintE*)ds.idx.reserve(m * sizeof(uintE), false);
+    parallel_for(size_t i = 0; i < m; i++) idx[i] = get(i);
+    ds.k = m;
+  }
+
+  void releaseLocal() {
+    for (int i = 0; i < numLocal; i++) local[i].release();
+  }
+
+  void del() {
+    for (int i = 0; i < num_scratch; i++) scratch[i].release();
+    if (local != NULL) { releaseLocal(); delete[] local; local = NULL; numLocal = 0; }
+    for (int i = 0; i < 2; i++) {
+      sparse[i].release(); dense[i].release(); bits[i].release();
+      summary[i].release();
+      denseDirty[i].idx.release(); bitsDirty[i].idx.release();
+      denseDirty[i].all = bitsDirty[i].all = 1;
+    }
+  }
+};
+
+#endif
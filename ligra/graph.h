@@ -3,10 +3,13 @@
 #include <iostream>
 #include <fstream>
 #include <stdlib.h>
+#include <algorithm>
 #include "vertex.h"
 #include "compressedVertex.h"
+#include "csrVertex.h"
 #include "parallel.h"
 #include "utils.h"
+#include "frontierPool.h"
 using namespace std;
 
 // **************************************************************
@@ -18,6 +21,7 @@ using namespace std;
 struct Deletable {
 public:
   virtual void del() = 0;
+  virtual ~Deletable() {}
 };
 
 /**
@@ -36,13 +40,13 @@ public:
   Uncompressed_Mem(vertex* VV, long nn, long mm, void* ai, void* _inEdges = NULL)
   : V(VV), n(nn), m(mm), allocatedInplace(ai), inEdges(_inEdges) { }
 
+  // The binary loader takes V and the edges from pageAlloc, hence pageFree.
   void del() {
-    /*if (allocatedInplace == NULL)
+    if (allocatedInplace == NULL)
       for (long i=0; i < n; i++) V[i].del();
-    else free(allocatedInplace);
-    free(V);
-    if(inEdges != NULL) free(inEdges);
-    */
+    else pageFree(allocatedInplace);
+    pageFree(V);
+    if(inEdges != NULL) pageFree(inEdges);
   }
 };
 
@@ -80,8 +84,8 @@ public:
                  V(_V), s(_s) { }
 
   void del() {
-    free(V);
-    free(s);
+    pageFree(V);
+    pageFree(s);
   }
 };
 
@@ -102,6 +106,33 @@ public:
   }
 };
 
+// Folds the block of each in-neighbor into *mask (see blockFoldBit). The
+// compressed decoders copy the functor, hence the pointer.
+struct inBlockFoldF {
+  uint64_t* mask;
+  inBlockFoldF(uint64_t* _mask) : mask(_mask) {}
+  inline bool update(uintE s, uintE d) { *mask |= blockFoldBit(s); return false; }
+  inline bool updateAtomic(uintE s, uintE d) { return update(s, d); }
+  template <class W>
+  inline bool update(uintE s, uintE d, W w) { return update(s, d); }
+  template <class W>
+  inline bool updateAtomic(uintE s, uintE d, W w) { return update(s, d); }
+  inline bool cond(uintE d) { return true; }
+};
+
+struct allInView {
+  inline bool isIn(const uintE& v) const { return true; }
+};
+
+// Vertex boundaries of the edge_parallel tasks of the dense edgeMaps: task i
+// covers [bounds[i], bounds[i+1]) for i < k.
+struct edgeSplits {
+  uintE* bounds;
+  long k;
+  long grain;
+  edgeSplits() : bounds(NULL), k(0), grain(0) {}
+};
+
 template <class vertex>
 struct graph {
   //TODO: Graph里的点集用的是指针？不会是malloc吧
@@ -110,33 +141,122 @@ struct graph {
   long m;
   bool transposed;
   uintE* flags;
+  uint64_t* dedupBits;
+  frontierPool* pool;
+  uint64_t* inBlockMasks[2]; // indexed by transposed
+  edgeSplits splits[2][2];    // indexed by transposed, then in/out edges
+  vertex** VR; // per-node copies of V under -numa (see numaReplicate)
   Deletable *D;
 
 graph(vertex* _V, long _n, long _m, Deletable* _D) : V(_V), n(_n), m(_m),
-  D(_D), flags(NULL), transposed(0) {}
+  D(_D), flags(NULL), dedupBits(NULL), pool(NULL), VR(NULL), transposed(0) { inBlockMasks[0] = inBlockMasks[1] = NULL; }
 
 graph(vertex* _V, long _n, long _m, Deletable* _D, uintE* _flags) : V(_V),
-  n(_n), m(_m), D(_D), flags(_flags), transposed(0) {}
+  n(_n), m(_m), D(_D), flags(_flags), dedupBits(NULL), pool(NULL), VR(NULL), transposed(0) { inBlockMasks[0] = inBlockMasks[1] = NULL; }
 
   void del() {
     if (flags != NULL) free(flags);
+    if (dedupBits != NULL) free(dedupBits);
+    if (pool != NULL) { pool->del(); delete pool; }
+    for (int i = 0; i < 2; i++) {
+      if (inBlockMasks[i] != NULL) free(inBlockMasks[i]);
+      for (int j = 0; j < 2; j++) if (splits[i][j].bounds != NULL) free(splits[i][j].bounds);
+    }
+    if (VR != NULL) {
+      for (int k = 0; k < numaNodes(); k++) pageFree(VR[k]);
+      free(VR);
+    }
     D->del();
-    free(D);
+    delete D;
   }
 
-  void print_address(){
-	//for(int i=0;i<=n;i++){
-	//	pbbs::print_addr("Vertex set", (unsigned long)(void*)(V+i));
-	//}
-    //pbbs::print_address("Vertex set", (unsigned long)(void*)V, (unsigned long)(void*)(V+n));
-    //pbbs::print_address("Adj",(unsigned long)(void*)(uintE *)D, (unsigned long)(void*)(uintE *)(D+m));
+  // Workspace shared by all edgeMaps over this graph; created on first use.
+  frontierPool* getPool() {
+    if (pool == NULL) pool = new frontierPool();
+    return pool;
+  }
+
+  // One bit per vertex for the dedup_bitmap edgeMaps, which leave it all
+  // zero. Created on first use.
+  uint64_t* getDedupBits() {
+    if (dedupBits == NULL) {
+      size_t nw = bitmapWords(n);
+      dedupBits = newA(uint64_t, nw);
+      parallel_for(size_t w = 0; w < nw; w++) dedupBits[w] = 0;
+    }
+    return dedupBits;
+  }
+
+  // For each group of 64 consecutive vertices, the fold of the blocks of
+  // their in-neighbors. Built on first use (one pass over the in-edges).
+  uint64_t* getInBlockMasks() {
+    uint64_t*& masks = inBlockMasks[transposed];
+    if (masks == NULL) {
+      size_t nw = bitmapWords(n);
+      masks = newA(uint64_t, nw);
+      parallel_for(size_t w = 0; w < nw; w++) {
+        uint64_t mask = 0;
+        inBlockFoldF f(&mask);
+        allInView all;
+        auto g = [] (uintE ngh, bool m=false) {};
+        size_t end = min((size_t)n, (w+1)*64);
+        for (size_t v = w*64; v < end; v++) V[v].decodeInNghBreakEarly(v, all, f, g);
+        masks[w] = mask;
+      }
+    }
+    return masks;
+  }
+
+  // Splits the vertices into ranges of about grain in-edges (out-edges if
+  // out); a vertex of degree above grain gets a range of its own. Built on
+  // first use and rebuilt if grain changes.
+  edgeSplits& getEdgeSplits(bool out, long grain) {
+    edgeSplits& e = splits[transposed][out];
+    if (e.bounds == NULL || e.grain != grain) {
+      if (e.bounds != NULL) free(e.bounds);
+      long* offsets = newA(long, n+1);
+      {parallel_for(long i = 0; i < n; i++)
+        offsets[i] = out ? V[i].getOutDegree() : V[i].getInDegree();}
+      offsets[n] = sequence::plusScan(offsets, offsets, n);
+      e.k = offsets[n] / grain + 1;
+      e.grain = grain;
+      e.bounds = newA(uintE, e.k + 1);
+      {parallel_for(long i = 0; i < e.k; i++)
+        e.bounds[i] = std::lower_bound(offsets, offsets + n, i * grain) - offsets;}
+      e.bounds[e.k] = n;
+      free(offsets);
+    }
+    return e;
+  }
+
+  // Gives every node its own copy of V, which the dense edgeMap loops read
+  // through localV(). Vertices are small and read on every edgeMap, so this
+  // trades memory for local reads. Does nothing unless numaNodes() > 1.
+  void numaReplicate() {
+    int nodes = numaNodes();
+    if (nodes <= 1 || VR != NULL) return;
+    VR = newA(vertex*, nodes);
+    for (int k = 0; k < nodes; k++)
+      VR[k] = (vertex*) pageReplica(V, sizeof(vertex) * (n + vertexView<vertex>::extra),
+                                    "VerticesReplica", k);
+  }
+
+  // The copy of V on the node of the calling worker.
+  vertex* localV() { return (VR == NULL) ? V : VR[numa_this_node]; }
+
+  // Copies vertex v (after a change to V[v]) to the replicas.
+  void numaSync(long v) {
+    if (VR == NULL) return;
+    for (int k = 0; k < numaNodes(); k++) VR[k][v] = V[v];
   }
 
   void transpose() {
     if ((sizeof(vertex) == sizeof(asymmetricVertex)) ||
-        (sizeof(vertex) == sizeof(compressedAsymmetricVertex))) {
-      parallel_for(long i=0;i<n;i++) {
+        (sizeof(vertex) == sizeof(compressedAsymmetricVertex)) ||
+        std::is_same<vertex, csrAsymmetricVertex>::value) {
+      parallel_for(long i=0;i<n+vertexView<vertex>::extra;i++) {
         V[i].flipEdges();
+        numaSync(i);
       }
       transposed = !transposed;
     }
@@ -164,7 +284,7 @@ hypergraph(vertex* _V, vertex* _H, long _nv, long _mv, long _nh, long _mh,  Dele
   void del() {
     if (flags != NULL) free(flags);
     D->del();
-    free(D);
+    delete D;
   }
   void initFlags() {
     flags = newA(uintE,max(nv,nh));
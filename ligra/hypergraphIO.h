@@ -349,54 +349,38 @@ hypergraph<vertex> readHypergraphFromBinary(char* iFile, bool isSymmetric) {
   in >> nv; in >> mv; in >> nh; in >> mh;
   in.close();
 
-  ifstream in2(vadjFile,ifstream::in | ios::binary); //stored as uints
-  in2.seekg(0, ios::end);
-  long size = in2.tellg();
-  in2.seekg(0);
+  long size = fileSize(vadjFile); //stored as uints
 #ifdef WEIGHTED
   if(mv != size/(2*sizeof(uint))) { cout << "size wrong\n"; exit(0); }
 #else
   if(mv != size/(sizeof(uint))) { cout << "size wrong\n"; exit(0); }
 #endif
   char* s = (char *) malloc(size);
-  in2.read(s,size);
-  in2.close();
+  readFileParallel(vadjFile,s,size);
   uintE* edgesV = (uintE*) s;
 
-  ifstream in3(vidxFile,ifstream::in | ios::binary); //stored as longs
-  in3.seekg(0, ios::end);
-  size = in3.tellg();
-  in3.seekg(0);
+  size = fileSize(vidxFile); //stored as longs
   if(nv != size/sizeof(intT)) { cout << "File size wrong\n"; abort(); }
 
   char* t = (char *) malloc(size);
-  in3.read(t,size);
-  in3.close();
+  readFileParallel(vidxFile,t,size);
   uintT* offsetsV = (uintT*) t;
 
-  ifstream in4(hadjFile,ifstream::in | ios::binary); //stored as uints
-  in4.seekg(0, ios::end);
-  size = in4.tellg();
-  in4.seekg(0);
+  size = fileSize(hadjFile); //stored as uints
 #ifdef WEIGHTED
   if(mh != size/(2*sizeof(uint))) { cout << "size wrong\n"; exit(0); }
 #else
   if(mh != size/(sizeof(uint))) { cout << "size wrong\n"; exit(0); }
 #endif
   char* s2 = (char *) malloc(size);
-  in4.read(s2,size);
-  in4.close();
+  readFileParallel(hadjFile,s2,size);
   uintE* edgesH = (uintE*) s2;
 
-  ifstream in5(hidxFile,ifstream::in | ios::binary); //stored as longs
-  in5.seekg(0, ios::end);
-  size = in5.tellg();
-  in5.seekg(0);
+  size = fileSize(hidxFile); //stored as longs
   if(nh != size/sizeof(intT)) { cout << "File size wrong\n"; abort(); }
 
   char* t2 = (char *) malloc(size);
-  in5.read(t2,size);
-  in5.close();
+  readFileParallel(hidxFile,t2,size);
   uintT* offsetsH = (uintT*) t2;
 
   vertex* v = newA(vertex,nv+1);
@@ -643,14 +627,10 @@ hypergraph<vertex> readCompressedHypergraph(char* fname, bool isSymmetric, bool
     }
     s = bytes;
   } else {
-    ifstream in(fname,ifstream::in |ios::binary);
-    in.seekg(0,ios::end);
-    long size = in.tellg();
-    in.seekg(0);
+    long size = fileSize(fname);
     cout << "size = " << size << endl;
     s = (char*) malloc(size);
-    in.read(s,size);
-    in.close();
+    readFileParallel(fname,s,size);
   }
 
   long* sizesV = (long*) s;
@@ -37,9 +37,11 @@
 #include "vertexSubset.h"
 #include "graph.h"
 #include "IO.h"
+#include "memMap.h"
 #include "parseCommandLine.h"
 #include "index_map.h"
 #include "edgeMap_utils.h"
+#include "directionPolicy.h"
 using namespace std;
 
 //*****START FRAMEWORK*****
@@ -53,83 +55,443 @@ const flags dense_parallel = 16;
 const flags remove_duplicates = 32;
 const flags no_dense = 64;
 const flags edge_parallel = 128;
+// The output frontier (and any conversion of the input frontier) lives in the
+// graph's double-buffered frontierPool rather than in fresh allocations. Only
+// valid when each round's output is the next round's input and older
+// frontiers are no longer used, as in Frontier = edgeMap(GA, Frontier, ...).
+const flags reuse_frontier = 256;
+// Dense rounds of an edgeMap without output data use a bitmap (one bit per
+// vertex) for the input and output frontiers instead of a bool array.
+const flags dense_bitmap = 512;
+// Dense (pull) rounds reading a vertexSubset consult a one-bit-per-block
+// summary of the frontier before probing it, and skip destinations none of
+// whose in-neighbor blocks are active. Pays off when vertex ids have
+// locality and the frontier is clustered.
+const flags dense_block_skip = 1024;
+// Sparse rounds append their output to per-worker buffers (see
+// edgeMapSparse_local) instead of writing one slot per out-edge.
+const flags sparse_local = 2048;
+// edgeMapApply calls its apply functor on every vertex rather than only on
+// the vertices the edgeMap updated.
+const flags apply_all = 4096;
+// Dense rounds use the prefetching decoders of vertex.h, which prefetch the
+// frontier entry and functor state (see prefetchSource/prefetchTarget) of the
+// neighbor PREFETCH_DISTANCE positions ahead, and pulls prefetch the next
+// vertex's in-neighbors. Only the uncompressed decoders prefetch.
+const flags prefetch_ngh = 8192;
+#ifndef PREFETCH_DISTANCE
+#define PREFETCH_DISTANCE 8
+#endif
+// Like remove_duplicates, but duplicates are dropped as they are produced:
+// the first successful update of a destination sets its bit in an n-bit map
+// (GA.getDedupBits()) and later ones are treated as failed. Bits are cleared
+// from the output, so the map costs n/8 bytes and no extra pass over the
+// edges. Sparse rounds only, like remove_duplicates.
+const flags dedup_bitmap = 16384;
+// Edges per task of the dense edgeMaps under edge_parallel (-edgegrain).
+static long dense_edge_grain = 1024;
+// Out-edges per task of edgeMapSparse for high-degree frontier vertices
+// (-hubgrain). A vertex with more out-edges is decoded by several tasks,
+// each taking a range of about this many of its edges.
+static long sparse_hub_grain = 4096;
 inline bool should_output(const flags &fl) { return !(fl & no_output); }
 
+// Allocates an n-element output array for an edgeMap, drawing from the
+// graph's frontier pool if reuse_frontier is set.
+template <class T>
+inline T *nextSparseArray(frontierPool *pool, size_t n, const flags fl)
+{
+  return (fl & reuse_frontier) ? pool->nextSparse<T>(n) : newA(T, n);
+}
+
+template <class T>
+inline T *nextDenseArray(frontierPool *pool, size_t n, const flags fl)
+{
+  return (fl & reuse_frontier) ? pool->nextDense<T>(n) : newA(T, n);
+}
+
+// Vertices per chunk claimed by a worker in numaFor.
+static const long numa_chunk = 2048;
+
+// Calls body(v) for every v in [0, n) when numaNodes() > 1. The vertices are
+// split into the per-node ranges of numa_partition (numaRange); each worker
+// takes chunks of the range of its own node first and then helps with the
+// others, so most vertices (and their state) are handled on their node.
+template <class B>
+inline void numaFor(long n, B body)
+{
+  int nodes = numaNodes();
+  std::vector<long> next(nodes * 8); // one counter per cache line
+  for (int k = 0; k < nodes; k++)
+    next[k * 8] = numaRange(n, k);
+  parallel_for_1(long t = 0; t < getWorkers(); t++)
+  {
+    int home = numaCurrentNode();
+    numa_this_node = home;
+    for (int j = 0; j < nodes; j++)
+    {
+      int k = (home + j) % nodes;
+      long hi = numaRange(n, k + 1);
+      for (long lo; (lo = __sync_fetch_and_add(&next[k * 8], numa_chunk)) < hi;)
+        for (long v = lo; v < min(hi, lo + numa_chunk); v++)
+          body(v);
+    }
+  }
+}
+
+// Calls body(v) for every vertex. Under edge_parallel, vertices are split
+// into tasks of about dense_edge_grain in-edges (out-edges if out) instead
+// of by count, so that a hub does not serialize the vertices around it.
+// Otherwise, with several NUMA nodes, the loop follows the node partition.
+template <class vertex, class B>
+inline void denseFor(graph<vertex> &GA, const flags fl, bool out, B body)
+{
+  if (fl & edge_parallel)
+  {
+    edgeSplits &sp = GA.getEdgeSplits(out, dense_edge_grain);
+    uintE *bounds = sp.bounds;
+    parallel_for_1(long i = 0; i < sp.k; i++)
+    {
+      for (uintE v = bounds[i]; v < bounds[i + 1]; v++)
+        body(v);
+    }
+  }
+  else if (numaNodes() > 1)
+  {
+    numaFor(GA.n, body);
+  }
+  else
+  {
+    parallel_for(long v = 0; v < GA.n; v++) body(v);
+  }
+}
+
+// Decodes the in-edges of vertex v for a pull, prefetching under prefetch_ngh.
+template <class vertex, class VS, class F, class G>
+inline void denseInNgh(graph<vertex> &GA, long v, VS &vs, F &f, G &g, const flags fl)
+{
+  vertex *V = GA.localV();
+  if (fl & prefetch_ngh)
+  {
+    if (v + 1 < GA.n)
+      __builtin_prefetch(V[v + 1].getInNeighbors());
+    V[v].template decodeInNghBreakEarly<PREFETCH_DISTANCE>(v, vs, f, g, fl & dense_parallel);
+  }
+  else
+    V[v].decodeInNghBreakEarly(v, vs, f, g, fl & dense_parallel);
+}
+
+// Decodes the out-edges of frontier vertex i for a forward dense round.
+template <class vertex, class F, class G>
+inline void denseOutNgh(graph<vertex> &GA, long i, F &f, G &g, const flags fl)
+{
+  vertex *V = GA.localV();
+  if (fl & prefetch_ngh)
+    V[i].template decodeOutNgh<PREFETCH_DISTANCE>(i, f, g);
+  else
+    V[i].decodeOutNgh(i, f, g);
+}
+
 template <class data, class vertex, class VS, class F>
-vertexSubsetData<data> edgeMapDense(graph<vertex> GA, VS &vertexSubset, F &f, const flags fl)
+vertexSubsetData<data> edgeMapDense(graph<vertex> &GA, VS &vertexSubset, F &f, const flags fl)
 {
   using D = tuple<bool, data>;
   long n = GA.n;
-  vertex *G = GA.V;
   if (should_output(fl))
   {
-    //[内存]这里又搞了个新内存。
-    D *next = newA(D, n);
+    D *next = nextDenseArray<D>(GA.pool, n, fl);
     auto g = get_emdense_gen<data>(next);
-    parallel_for(long v = 0; v < n; v++)
-    {
+    denseFor(GA, fl, false, [&](long v)
+             {
       std::get<0>(next[v]) = 0;
       if (f.cond(v))
       {
-        G[v].decodeInNghBreakEarly(v, vertexSubset, f, g, fl & dense_parallel);
-      }
-    }
+        denseInNgh(GA, v, vertexSubset, f, g, fl);
+      } });
     return vertexSubsetData<data>(n, next);
   }
   else
   {
     auto g = get_emdense_nooutput_gen<data>();
-    parallel_for(long v = 0; v < n; v++)
-    {
+    denseFor(GA, fl, false, [&](long v)
+             {
       if (f.cond(v))
       {
-        G[v].decodeInNghBreakEarly(v, vertexSubset, f, g, fl & dense_parallel);
-      }
-    }
+        denseInNgh(GA, v, vertexSubset, f, g, fl);
+      } });
     return vertexSubsetData<data>(n);
   }
 }
 
 template <class data, class vertex, class VS, class F>
-vertexSubsetData<data> edgeMapDenseForward(graph<vertex> GA, VS &vertexSubset, F &f, const flags fl)
+vertexSubsetData<data> edgeMapDenseForward(graph<vertex> &GA, VS &vertexSubset, F &f, const flags fl)
 {
   using D = tuple<bool, data>;
   long n = GA.n;
-  vertex *G = GA.V;
   if (should_output(fl))
   {
-    D *next = newA(D, n);
+    D *next = nextDenseArray<D>(GA.pool, n, fl);
     auto g = get_emdense_forward_gen<data>(next);
     parallel_for(long i = 0; i < n; i++) { std::get<0>(next[i]) = 0; }
-    parallel_for(long i = 0; i < n; i++)
-    {
+    denseFor(GA, fl, true, [&](long i)
+             {
       if (vertexSubset.isIn(i))
       {
-        G[i].decodeOutNgh(i, f, g);
-      }
-    }
+        denseOutNgh(GA, i, f, g, fl);
+      } });
     return vertexSubsetData<data>(n, next);
   }
   else
   {
     auto g = get_emdense_forward_nooutput_gen<data>();
-    parallel_for(long i = 0; i < n; i++)
-    {
+    denseFor(GA, fl, true, [&](long i)
+             {
       if (vertexSubset.isIn(i))
       {
-        G[i].decodeOutNgh(i, f, g);
+        denseOutNgh(GA, i, f, g, fl);
+      } });
+    return vertexSubsetData<data>(n);
+  }
+}
+
+// edgeMapDense producing a bitmap. Unless edge_parallel, each task owns one
+// output word; vs is either the vertexSubset or a view of it.
+template <class vertex, class VS, class F>
+vertexSubset edgeMapDenseBits(graph<vertex> &GA, VS &vs, F &f, const flags fl)
+{
+  long n = GA.n;
+  size_t nw = bitmapWords(n);
+  if (should_output(fl))
+  {
+    uint64_t *next = (fl & reuse_frontier) ? GA.pool->nextBits(nw) : newA(uint64_t, nw);
+    auto g = get_emdense_bits_gen(next);
+    if (fl & edge_parallel)
+    {
+      parallel_for(size_t w = 0; w < nw; w++) { next[w] = 0; }
+      denseFor(GA, fl, false, [&](long v)
+               {
+        if (f.cond(v))
+        {
+          denseInNgh(GA, v, vs, f, g, fl);
+        } });
+      return vertexSubset(n, next);
+    }
+    parallel_for(size_t w = 0; w < nw; w++)
+    {
+      next[w] = 0;
+      size_t end = min((size_t)n, (w + 1) * 64);
+      for (size_t v = w * 64; v < end; v++)
+      {
+        if (f.cond(v))
+        {
+          denseInNgh(GA, v, vs, f, g, fl);
+        }
       }
     }
-    return vertexSubsetData<data>(n);
+    return vertexSubset(n, next);
+  }
+  else
+  {
+    auto g = get_emdense_nooutput_gen<pbbs::empty>();
+    denseFor(GA, fl, false, [&](long v)
+             {
+      if (f.cond(v))
+      {
+        denseInNgh(GA, v, vs, f, g, fl);
+      } });
+    return vertexSubset(n);
+  }
+}
+
+// edgeMapDenseForward over a bitmap frontier. Unless edge_parallel, tasks
+// skip empty words.
+template <class vertex, class F, class G>
+inline void denseForwardBitsLoop(graph<vertex> &GA, uint64_t *bits, F &f, G &g, const flags fl)
+{
+  if (fl & edge_parallel)
+  {
+    denseFor(GA, fl, true, [&](long i)
+             {
+      if (bitmapIn(bits, i))
+      {
+        denseOutNgh(GA, i, f, g, fl);
+      } });
+    return;
+  }
+  size_t nw = bitmapWords(GA.n);
+  parallel_for(size_t w = 0; w < nw; w++)
+  {
+    if (bits[w])
+      bitmapForWord(bits[w], w, [&](size_t i) { denseOutNgh(GA, i, f, g, fl); });
+  }
+}
+
+template <class vertex, class F>
+vertexSubset edgeMapDenseForwardBits(graph<vertex> &GA, vertexSubset &vs, F &f, const flags fl)
+{
+  long n = GA.n;
+  size_t nw = bitmapWords(n);
+  if (should_output(fl))
+  {
+    uint64_t *next = (fl & reuse_frontier) ? GA.pool->nextBits(nw) : newA(uint64_t, nw);
+    auto g = get_emdense_bits_gen(next);
+    parallel_for(size_t w = 0; w < nw; w++) { next[w] = 0; }
+    denseForwardBitsLoop(GA, vs.bits, f, g, fl);
+    return vertexSubset(n, next);
+  }
+  else
+  {
+    auto g = get_emdense_forward_nooutput_gen<pbbs::empty>();
+    denseForwardBitsLoop(GA, vs.bits, f, g, fl);
+    return vertexSubset(n);
+  }
+}
+
+// Pull-based dense edgeMap reading the frontier through in (a vertexSubset
+// or one of the views in vertexSubset.h). With dense_bitmap, an edgeMap
+// without output data writes a bitmap.
+template <class data, class vertex, class IN, class F,
+          typename std::enable_if<std::is_same<data, pbbs::empty>::value, int>::type = 0>
+vertexSubsetData<data> edgeMapDensePull(graph<vertex> &GA, IN &in, F &f, const flags fl)
+{
+  if (fl & dense_bitmap)
+    return edgeMapDenseBits(GA, in, f, fl);
+  return edgeMapDense<data, vertex, IN, F>(GA, in, f, fl);
+}
+
+template <class data, class vertex, class IN, class F,
+          typename std::enable_if<!std::is_same<data, pbbs::empty>::value, int>::type = 0>
+vertexSubsetData<data> edgeMapDensePull(graph<vertex> &GA, IN &in, F &f, const flags fl)
+{
+  return edgeMapDense<data, vertex, IN, F>(GA, in, f, fl);
+}
+
+// Forward (write-based) dense edgeMap from a vertexSubset, over a bitmap
+// with dense_bitmap when there is no output data.
+template <class data, class vertex, class F,
+          typename std::enable_if<std::is_same<data, pbbs::empty>::value, int>::type = 0>
+vertexSubsetData<data> edgeMapDensePush(graph<vertex> &GA, vertexSubset &vs, F &f, const flags fl,
+                                        frontierPool *vsPool)
+{
+  if (fl & dense_bitmap)
+  {
+    vs.toBits(vsPool);
+    return edgeMapDenseForwardBits(GA, vs, f, fl);
+  }
+  vs.toDense(vsPool);
+  return edgeMapDenseForward<data, vertex, vertexSubset, F>(GA, vs, f, fl);
+}
+
+template <class data, class vertex, class F,
+          typename std::enable_if<!std::is_same<data, pbbs::empty>::value, int>::type = 0>
+vertexSubsetData<data> edgeMapDensePush(graph<vertex> &GA, vertexSubset &vs, F &f, const flags fl,
+                                        frontierPool *vsPool)
+{
+  vs.toDense(vsPool);
+  return edgeMapDenseForward<data, vertex, vertexSubset, F>(GA, vs, f, fl);
+}
+
+// Pull with dense_block_skip: probes first check the frontier summary, and
+// destinations whose in-neighbor blocks all miss it are skipped through cond.
+template <class data, class vertex, class IN, class F>
+vertexSubsetData<data> edgeMapDenseSkip(graph<vertex> &GA, vertexSubset &vs, IN &in, F &f,
+                                        const flags fl, frontierPool *vsPool)
+{
+  if (!(fl & dense_block_skip))
+    return edgeMapDensePull<data, vertex, IN, F>(GA, in, f, fl);
+  vs.toSummary(vsPool);
+  summaryView<IN> sv(in, vs.summary);
+  blockSkipF<F> bf(f, GA.getInBlockMasks(), vs.summaryFold());
+  return edgeMapDensePull<data, vertex, summaryView<IN>, blockSkipF<F>>(GA, sv, bf, fl);
+}
+
+// Runs the dense direction of edgeMapData. A vertexSubset input can be read
+// as a bitmap (dense_bitmap; a bool input is pulled from as is, and only
+// converted for the forward version) and through its summary
+// (dense_block_skip).
+template <class data, class vertex, class VS, class F,
+          typename std::enable_if<std::is_same<VS, vertexSubset>::value, int>::type = 0>
+vertexSubsetData<data> edgeMapDenseAny(graph<vertex> &GA, VS &vs, F &f, const flags fl, frontierPool *vsPool)
+{
+  if (fl & dense_forward)
+    return edgeMapDensePush<data, vertex, F>(GA, vs, f, fl, vsPool);
+  if (!(std::is_same<data, pbbs::empty>::value && (fl & dense_bitmap)))
+    vs.toDense(vsPool);
+  else if (vs.d == NULL)
+  {
+    vs.toBits(vsPool);
+    bitmapView bv(vs.bits);
+    return edgeMapDenseSkip<data, vertex, bitmapView, F>(GA, vs, bv, f, fl, vsPool);
+  }
+  return edgeMapDenseSkip<data, vertex, VS, F>(GA, vs, vs, f, fl, vsPool);
+}
+
+template <class data, class vertex, class VS, class F,
+          typename std::enable_if<!std::is_same<VS, vertexSubset>::value, int>::type = 0>
+vertexSubsetData<data> edgeMapDenseAny(graph<vertex> &GA, VS &vs, F &f, const flags fl, frontierPool *vsPool)
+{
+  vs.toDense(vsPool);
+  return (fl & dense_forward) ? edgeMapDenseForward<data, vertex, VS, F>(GA, vs, f, fl) : edgeMapDense<data, vertex, VS, F>(GA, vs, f, fl);
+}
+
+// Whether a sparse edgeMap with flags fl runs remDuplicates on its output.
+inline bool should_remDuplicates(const flags &fl)
+{
+  return (fl & remove_duplicates) && !(fl & dedup_bitmap);
+}
+
+// Clears the dedup_bitmap bits of the k vertices of an output, which are the
+// only ones set.
+template <class S>
+inline void clearDedupBits(uint64_t *bits, S *out, size_t k)
+{
+  parallel_for(size_t i = 0; i < k; i++) { bits[std::get<0>(out[i]) >> 6] = 0; }
+}
+
+// Calls decode(i, lo, hi) on the out-edges [lo, hi) of each of the m frontier
+// vertices: all of them for most vertices, and in pieces of about
+// sparse_hub_grain edges (rounded up to the vertex's outSplitUnit) for
+// those with more, so that a hub's edges spread over the workers. The
+// pieces are found by a binary search in the scan of the piece counts.
+template <class vertex, class D>
+inline void sparseFor(graph<vertex> &GA, typename vertexView<vertex>::type *frontierVertices, uintT m, D decode)
+{
+  long unit = vertex::outSplitUnit();
+  uintT piece = (unit == 0) ? 0 : ((sparse_hub_grain + unit - 1) / unit) * unit;
+  frontierPool *pool = GA.getPool();
+  uintT *pieces = pool->getScratch<uintT>(frontierPool::pieces_slot, m + 1);
+  parallel_for(size_t i = 0; i < m; i++)
+  {
+    uintT d = frontierVertices[i].getOutDegree();
+    pieces[i] = (piece == 0 || d <= piece) ? 1 : (d + piece - 1) / piece;
+  }
+  size_t total = sequence::plusScan(pieces, pieces, m);
+  if (total == m)
+  {
+    parallel_for(size_t i = 0; i < m; i++) decode(i, 0, frontierVertices[i].getOutDegree());
+    return;
+  }
+  auto pieces_m = make_in_imap<uintT>(m, [&](size_t i)
+                                      { return pieces[i]; });
+  auto lt = [](const uintT &l, const uintT &r)
+  { return l < r; };
+  parallel_for_1(size_t p = 0; p < total; p++)
+  {
+    // the vertex of piece p is the last one whose pieces start at or before p
+    size_t i = pbbs::binary_search(pieces_m, (uintT)(p + 1), lt) - 1;
+    uintT d = frontierVertices[i].getOutDegree();
+    uintT lo = (p - pieces[i]) * piece;
+    decode(i, lo, (d - lo > piece) ? lo + piece : d);
   }
 }
 
 template <class data, class vertex, class VS, class F>
-vertexSubsetData<data> edgeMapSparse(graph<vertex> &GA, vertex *frontierVertices, VS &indices,
+vertexSubsetData<data> edgeMapSparse(graph<vertex> &GA, typename vertexView<vertex>::type *frontierVertices, VS &indices,
                                      uintT *degrees, uintT m, F &f, const flags fl)
 {
   using S = tuple<uintE, data>;
   long n = indices.n;
+  frontierPool *pool = GA.getPool();
   S *outEdges;
   long outEdgeCount = 0;
 
@@ -137,30 +499,44 @@ vertexSubsetData<data> edgeMapSparse(graph<vertex> &GA, vertex *frontierVertices
   {
     uintT *offsets = degrees;
     outEdgeCount = sequence::plusScan(offsets, offsets, m);
-    outEdges = newA(S, outEdgeCount);
+    outEdges = pool->getScratch<S>(frontierPool::edges_slot, outEdgeCount);
+    auto decode = [&](auto &g)
+    {
+      sparseFor(GA, frontierVertices, m, [&](size_t i, uintT lo, uintT hi)
+                {
+        uintT v = indices.vtx(i), o = offsets[i];
+        auto vert = frontierVertices[i];
+        if (lo == 0 && hi == vert.getOutDegree())
+          vert.decodeOutNghSparse(v, o, f, g);
+        else
+          vert.decodeOutNghSparseRange(v, o, lo, hi, f, g); });
+    };
     auto g = get_emsparse_gen<data>(outEdges);
-    parallel_for(size_t i = 0; i < m; i++)
+    if (fl & dedup_bitmap)
     {
-      uintT v = indices.vtx(i), o = offsets[i];
-      vertex vert = frontierVertices[i];
-      vert.decodeOutNghSparse(v, o, f, g);
+      auto dg = get_emsparse_dedup_gen(g, GA.getDedupBits());
+      decode(dg);
     }
+    else
+      decode(g);
   }
   else
   {
     auto g = get_emsparse_nooutput_gen<data>();
-    parallel_for(size_t i = 0; i < m; i++)
-    {
+    sparseFor(GA, frontierVertices, m, [&](size_t i, uintT lo, uintT hi)
+              {
       uintT v = indices.vtx(i);
-      vertex vert = frontierVertices[i];
-      vert.decodeOutNghSparse(v, 0, f, g);
-    }
+      auto vert = frontierVertices[i];
+      if (lo == 0 && hi == vert.getOutDegree())
+        vert.decodeOutNghSparse(v, 0, f, g);
+      else
+        vert.decodeOutNghSparseRange(v, 0, lo, hi, f, g); });
   }
 
   if (should_output(fl))
   {
-    S *nextIndices = newA(S, outEdgeCount);
-    if (fl & remove_duplicates)
+    S *nextIndices = nextSparseArray<S>(pool, outEdgeCount, fl);
+    if (should_remDuplicates(fl))
     {
       if (GA.flags == NULL)
       {
@@ -174,7 +550,8 @@ vertexSubsetData<data> edgeMapSparse(graph<vertex> &GA, vertex *frontierVertices
     auto p = [](tuple<uintE, data> &v)
     { return std::get<0>(v) != UINT_E_MAX; };
     size_t nextM = pbbs::filterf(outEdges, nextIndices, outEdgeCount, p);
-    free(outEdges);
+    if (fl & dedup_bitmap)
+      clearDedupBits(GA.getDedupBits(), nextIndices, nextM);
     return vertexSubsetData<data>(n, nextM, nextIndices);
   }
   else
@@ -183,24 +560,125 @@ vertexSubsetData<data> edgeMapSparse(graph<vertex> &GA, vertex *frontierVertices
   }
 }
 
+// Version of edgeMapSparse in which each worker appends the successful
+// updates to its own chunked buffer in the frontier pool; the buffers are
+// concatenated once at the end. The frontier is split into blocks of about
+// the same out-degree, each decoded sequentially by one worker.
+template <class data, class vertex, class VS, class F>
+vertexSubsetData<data> edgeMapSparse_local(graph<vertex> &GA,
+                                           typename vertexView<vertex>::type *frontierVertices, VS &indices, uintT *offsets, uintT m, F &f,
+                                           const flags fl)
+{
+  using S = tuple<uintE, data>;
+  long n = indices.n;
+  frontierPool *pool = GA.getPool();
+  long outEdgeCount = sequence::plusScan(offsets, offsets, m);
+
+  size_t b_size = 10000;
+  size_t n_blocks = nblocks(outEdgeCount, b_size);
+  size_t *block_offs = pool->getScratch<size_t>(frontierPool::blocks_slot, n_blocks + 1);
+  auto offsets_m = make_in_imap<uintT>(m, [&](size_t i)
+                                       { return offsets[i]; });
+  auto lt = [](const uintT &l, const uintT &r)
+  { return l < r; };
+  parallel_for(size_t i = 0; i < n_blocks; i++)
+  {
+    block_offs[i] = pbbs::binary_search(offsets_m, i * b_size, lt);
+  }
+  block_offs[n_blocks] = m;
+
+  int workers = getWorkers();
+  frontierPool::localBuffer *local = pool->getLocal(workers);
+  uint64_t *dedup = (fl & dedup_bitmap) ? GA.getDedupBits() : NULL;
+  parallel_for(size_t i = 0; i < n_blocks; i++)
+  {
+    if ((i == n_blocks - 1) || block_offs[i] != block_offs[i + 1])
+    {
+      // Sequential decoding keeps the block on one worker.
+      auto g = get_emsparse_local_gen<data>(&local[getWorkerNum()]);
+      auto dg = get_emsparse_dedup_gen(g, dedup);
+      for (size_t j = block_offs[i]; j < block_offs[i + 1]; j++)
+      {
+        if (dedup != NULL)
+          frontierVertices[j].decodeOutNghSparseSeq(indices.vtx(j), 0, f, dg);
+        else
+          frontierVertices[j].decodeOutNghSparseSeq(indices.vtx(j), 0, f, g);
+      }
+    }
+  }
+
+  // Lay out the chunks of all workers one after the other.
+  size_t chunk_size = frontierPool::local_chunk_bytes / sizeof(S);
+  long numChunks = 0;
+  for (int w = 0; w < workers; w++)
+    numChunks += local[w].used;
+  tuple<S *, size_t, size_t> *chunks =
+      pool->getScratch<tuple<S *, size_t, size_t>>(frontierPool::chunks_slot, numChunks);
+  size_t outSize = 0;
+  for (int w = 0, c = 0; w < workers; w++)
+  {
+    for (size_t j = 0; j < local[w].used; j++, c++)
+    {
+      size_t len = (j + 1 == local[w].used) ? local[w].fill / sizeof(S) : chunk_size;
+      chunks[c] = make_tuple((S *)local[w].chunks[j], len, outSize);
+      outSize += len;
+    }
+  }
+
+  // With remove_duplicates the output is filtered once more, so it only
+  // needs scratch space.
+  S *out = should_remDuplicates(fl) ? pool->getScratch<S>(frontierPool::packed_slot, outSize)
+                                    : nextSparseArray<S>(pool, outSize, fl);
+  parallel_for(long c = 0; c < numChunks; c++)
+  {
+    S *chunk = std::get<0>(chunks[c]);
+    size_t len = std::get<1>(chunks[c]), o = std::get<2>(chunks[c]);
+    for (size_t j = 0; j < len; j++)
+      out[o + j] = chunk[j];
+  }
+
+  if (should_remDuplicates(fl))
+  {
+    if (GA.flags == NULL)
+    {
+      GA.flags = newA(uintE, n);
+      parallel_for(size_t i = 0; i < n; i++) { GA.flags[i] = UINT_E_MAX; }
+    }
+    auto get_key = [&](size_t i) -> uintE &
+    { return std::get<0>(out[i]); };
+    remDuplicates(get_key, GA.flags, outSize, n);
+    S *nextIndices = nextSparseArray<S>(pool, outSize, fl);
+    auto p = [](tuple<uintE, data> &v)
+    { return std::get<0>(v) != UINT_E_MAX; };
+    size_t nextM = pbbs::filterf(out, nextIndices, outSize, p);
+    return vertexSubsetData<data>(n, nextM, nextIndices);
+  }
+  if (fl & dedup_bitmap)
+    clearDedupBits(GA.getDedupBits(), out, outSize);
+  return vertexSubsetData<data>(n, outSize, out);
+}
+
 template <class data, class vertex, class VS, class F>
 vertexSubsetData<data> edgeMapSparse_no_filter(graph<vertex> &GA,
-                                               vertex *frontierVertices, VS &indices, uintT *offsets, uintT m, F &f,
+                                               typename vertexView<vertex>::type *frontierVertices, VS &indices, uintT *offsets, uintT m, F &f,
                                                const flags fl)
 {
   using S = tuple<uintE, data>;
   long n = indices.n;
+  frontierPool *pool = GA.getPool();
   long outEdgeCount = sequence::plusScan(offsets, offsets, m);
-  S *outEdges = newA(S, outEdgeCount);
+  S *outEdges = pool->getScratch<S>(frontierPool::edges_slot, outEdgeCount);
 
   auto g = get_emsparse_no_filter_gen<data>(outEdges);
+  uint64_t *dedup = (fl & dedup_bitmap) ? GA.getDedupBits() : NULL;
+  auto dg = get_emsparse_dedup_gen(g, dedup);
 
   // binary-search into scan to map workers->chunks
   size_t b_size = 10000;
   size_t n_blocks = nblocks(outEdgeCount, b_size);
 
-  uintE *cts = newA(uintE, n_blocks + 1);
-  size_t *block_offs = newA(size_t, n_blocks + 1);
+  uintE *cts = pool->getScratch<uintE>(frontierPool::counts_slot, n_blocks + 1);
+  size_t *block_offs = pool->getScratch<size_t>(frontierPool::blocks_slot, n_blocks + 1);
 
   auto offsets_m = make_in_imap<uintT>(m, [&](size_t i)
                                        { return offsets[i]; });
@@ -224,7 +702,8 @@ vertexSubsetData<data> edgeMapSparse_no_filter(graph<vertex> &GA,
       for (size_t j = start; j < end; j++)
       {
         uintE v = indices.vtx(j);
-        size_t num_in = frontierVertices[j].decodeOutNghSparseSeq(v, k, f, g);
+        size_t num_in = (dedup != NULL) ? frontierVertices[j].decodeOutNghSparseSeq(v, k, f, dg)
+                                        : frontierVertices[j].decodeOutNghSparseSeq(v, k, f, g);
         k += num_in;
       }
       cts[i] = (k - start_o);
@@ -238,7 +717,10 @@ vertexSubsetData<data> edgeMapSparse_no_filter(graph<vertex> &GA,
   long outSize = sequence::plusScan(cts, cts, n_blocks);
   cts[n_blocks] = outSize;
 
-  S *out = newA(S, outSize);
+  // With remove_duplicates the packed edges are filtered once more, so they
+  // only need scratch space.
+  S *out = should_remDuplicates(fl) ? pool->getScratch<S>(frontierPool::packed_slot, outSize)
+                                    : nextSparseArray<S>(pool, outSize, fl);
 
   parallel_for(size_t i = 0; i < n_blocks; i++)
   {
@@ -254,11 +736,8 @@ vertexSubsetData<data> edgeMapSparse_no_filter(graph<vertex> &GA,
       }
     }
   }
-  free(outEdges);
-  free(cts);
-  free(block_offs);
 
-  if (fl & remove_duplicates)
+  if (should_remDuplicates(fl))
   {
     if (GA.flags == NULL)
     {
@@ -268,26 +747,84 @@ vertexSubsetData<data> edgeMapSparse_no_filter(graph<vertex> &GA,
     auto get_key = [&](size_t i) -> uintE &
     { return std::get<0>(out[i]); };
     remDuplicates(get_key, GA.flags, outSize, n);
-    S *nextIndices = newA(S, outSize);
+    S *nextIndices = nextSparseArray<S>(pool, outSize, fl);
     auto p = [](tuple<uintE, data> &v)
     { return std::get<0>(v) != UINT_E_MAX; };
     size_t nextM = pbbs::filterf(out, nextIndices, outSize, p);
-    free(out);
     return vertexSubsetData<data>(n, nextM, nextIndices);
   }
+  if (fl & dedup_bitmap)
+    clearDedupBits(GA.getDedupBits(), out, outSize);
   return vertexSubsetData<data>(n, outSize, out);
 }
 
-// Decides on sparse or dense base on number of nonzeros in the active vertices.
+// Pull in which apply(v) runs right after v's in-edges are processed, for
+// each v an update returned true for (every v with apply_all). The output
+// holds the v for which apply returned true.
+template <class vertex, class VS, class F, class A>
+vertexSubset edgeMapDenseApply(graph<vertex> &GA, VS &vs, F &f, A &apply, const flags fl)
+{
+  long n = GA.n;
+  bool *next = should_output(fl) ? nextDenseArray<bool>(GA.pool, n, fl) : NULL;
+  bool all = fl & apply_all;
+  denseFor(GA, fl, false, [&](long v)
+           {
+    bool touched = false;
+    auto g = [&touched](uintE ngh, bool m = false)
+    { if (m) touched = true; };
+    if (f.cond(v))
+    {
+      denseInNgh(GA, v, vs, f, g, fl);
+    }
+    bool keep = (all || touched) && apply(v);
+    if (next != NULL)
+      next[v] = keep; });
+  return (next != NULL) ? vertexSubset(n, next) : vertexSubset(n);
+}
+
+// Stands in for the apply functor when edgeMapDataApply runs a plain
+// edgeMapData.
+struct noApply
+{
+};
+
+// The apply functor of edgeMapApply with the caller's flags. applied is set
+// if apply was fused into a pull.
+template <class A>
+struct applyStep
+{
+  A &apply;
+  flags fl;
+  bool applied;
+  applyStep(A &_apply, flags _fl) : apply(_apply), fl(_fl), applied(false) {}
+};
+
 template <class data, class vertex, class VS, class F>
-vertexSubsetData<data> edgeMapData(graph<vertex> &GA, VS &vs, F f,
-                                   intT threshold = -1, const flags &fl = 0)
+vertexSubsetData<data> edgeMapDenseStep(graph<vertex> &GA, VS &vs, F &f, const flags fl,
+                                        frontierPool *vsPool, noApply &ap)
+{
+  return edgeMapDenseAny<data, vertex, VS, F>(GA, vs, f, fl, vsPool);
+}
+
+template <class data, class vertex, class VS, class F, class A>
+vertexSubsetData<data> edgeMapDenseStep(graph<vertex> &GA, VS &vs, F &f, const flags fl,
+                                        frontierPool *vsPool, applyStep<A> &ap)
+{
+  if (fl & dense_forward)
+    return edgeMapDenseAny<data, vertex, VS, F>(GA, vs, f, fl, vsPool);
+  ap.applied = true;
+  vs.toDense(vsPool);
+  return edgeMapDenseApply(GA, vs, f, ap.apply, ap.fl);
+}
+
+// Decides on sparse or dense using the direction policy dp (see
+// directionPolicy.h). ap is noApply, or the applyStep of an edgeMapApply.
+template <class data, class vertex, class VS, class F, class DP, class AP>
+vertexSubsetData<data> edgeMapDataApply(graph<vertex> &GA, VS &vs, F f,
+                                        DP &dp, const flags &fl, AP &ap)
 {
   //似乎Ligra有一个优化机制，可以查看subset里得非零点得数量,这个numNonzeros就是
   long numVertices = GA.n, numEdges = GA.m, m = vs.numNonzeros();
-  //如论文所说，除20就是threshold
-  if (threshold == -1)
-    threshold = numEdges / 20; // default threshold
   vertex *G = GA.V;
   if (numVertices != vs.numRows())
   {
@@ -297,178 +834,98 @@ vertexSubsetData<data> edgeMapData(graph<vertex> &GA, VS &vs, F f,
   //这里只传递了一个num，所以返回的subset肯定是空的
   if (m == 0)
     return vertexSubsetData<data>(numVertices);
-  //所以这两个都是临时数据结构，都是要free掉的。
+  // degrees and frontierVertices are per-call temporaries held in the pool.
+  frontierPool *pool = GA.getPool();
+  frontierPool *vsPool = (fl & reuse_frontier) ? pool : NULL;
   uintT *degrees = NULL;
-  vertex *frontierVertices = NULL;
+  typename vertexView<vertex>::type *frontierVertices = NULL;
   uintT outDegrees = 0;
+  bool hasDense = vs.hasDenseRepr(), hasSparse = vs.s != NULL;
 
-  if (threshold > 0)
-  { // compute sum of out-degrees if threshold > 0
-    vs.toSparse();
-    //[内存]新建一块连续区域，存放degree？
-    degrees = newA(uintT, m);
-    //[内存]frontier也被新建了
-    frontierVertices = newA(vertex, m);
+  // Fills degrees and frontierVertices from the sparse representation.
+  auto fillSparse = [&]()
+  {
+    vs.toSparse(vsPool);
+    degrees = pool->getScratch<uintT>(frontierPool::degrees_slot, m);
+    frontierVertices = pool->getScratch<typename vertexView<vertex>::type>(frontierPool::vertices_slot, m);
+    parallel_for(size_t i = 0; i < m; i++)
     {
-      parallel_for(size_t i = 0; i < m; i++)
-      {
-        
-        //在subset里，使用连续数组记录这些点的id的
-        //[BFS]这里在对frontier做遍历，v_id就是frontier里的某一个vertex
-        uintE v_id = vs.vtx(i);
-        //原图的数据结构vertex里记录了该点的临边
-        vertex v = G[v_id];
-        //获取临边的数量，放入degree里。degree是一个int
-        degrees[i] = v.getOutDegree();
-        //vs是一个subsetVertex的对象，而frontierVertices是一个vertex*数组，名字相近但是类型不一样。
-        frontierVertices[i] = v;
-      }
+      //在subset里，使用连续数组记录这些点的id的
+      uintE v_id = vs.vtx(i);
+      degrees[i] = G[v_id].getOutDegree();
+      frontierVertices[i] = vertexView<vertex>::get(G[v_id]);
+    }
+  };
+
+  if (dp.needsOutDegrees())
+  {
+    if (hasSparse || (fl & no_dense))
+    {
+      fillSparse();
+      outDegrees = sequence::plusReduce(degrees, m);
+    }
+    else
+    {
+      // Sum the degrees straight from the dense array so a frontier that
+      // stays dense is never packed.
+      auto deg_imap = make_in_imap<uintT>(numVertices, [&](size_t i)
+                                          { return vs.isIn(i) ? G[i].getOutDegree() : (uintT)0; });
+      outDegrees = pbbs::reduce_add(deg_imap);
     }
-    outDegrees = sequence::plusReduce(degrees, m);
     if (outDegrees == 0)
       return vertexSubsetData<data>(numVertices);
   }
-  if (!(fl & no_dense) && m + outDegrees > threshold)
+  directionInfo info = {numVertices, numEdges, m, (long)outDegrees, hasDense, hasSparse};
+  vertexSubsetData<data> vs_out;
+  if (!(fl & no_dense) && dp.dense(info))
   {
-    if (degrees)
-      free(degrees);
-    if (frontierVertices)
-      free(frontierVertices);
-    vs.toDense();
-    return (fl & dense_forward) ? edgeMapDenseForward<data, vertex, VS, F>(GA, vs, f, fl) : edgeMapDense<data, vertex, VS, F>(GA, vs, f, fl);
+    vs_out = edgeMapDenseStep<data, vertex, VS, F>(GA, vs, f, fl, vsPool, ap);
   }
   else
   {
+    if (degrees == NULL)
+      fillSparse();
     //通过frontierVertices这个vertex*数组，我们重新构造他们后继的subsetVertex，很合理。
-    auto vs_out =
-        (should_output(fl) && fl & sparse_no_filter) ? // only call snof when we output
-            edgeMapSparse_no_filter<data, vertex, VS, F>(GA, frontierVertices, vs, degrees, vs.numNonzeros(), f, fl)
-                                                     : edgeMapSparse<data, vertex, VS, F>(GA, frontierVertices, vs, degrees, vs.numNonzeros(), f, fl);
-    free(degrees);
-    free(frontierVertices);
-    return vs_out;
+    if (should_output(fl) && fl & sparse_local)
+      vs_out = edgeMapSparse_local<data, vertex, VS, F>(GA, frontierVertices, vs, degrees, vs.numNonzeros(), f, fl);
+    else
+      vs_out =
+          (should_output(fl) && fl & sparse_no_filter) ? // only call snof when we output
+              edgeMapSparse_no_filter<data, vertex, VS, F>(GA, frontierVertices, vs, degrees, vs.numNonzeros(), f, fl)
+                                                       : edgeMapSparse<data, vertex, VS, F>(GA, frontierVertices, vs, degrees, vs.numNonzeros(), f, fl);
+  }
+  if (fl & reuse_frontier)
+  {
+    // vs_out now occupies the other half of the pool's double buffer.
+    pool->flip();
+    vs_out.borrow();
   }
+  return vs_out;
+}
+
+// Decides on sparse or dense using the direction policy dp (see
+// directionPolicy.h).
+template <class data, class vertex, class VS, class F, class DP,
+          typename std::enable_if<std::is_class<DP>::value, int>::type = 0>
+vertexSubsetData<data> edgeMapData(graph<vertex> &GA, VS &vs, F f,
+                                   DP &dp, const flags &fl = 0)
+{
+  noApply ap;
+  return edgeMapDataApply<data>(GA, vs, f, dp, fl, ap);
 }
 
 // Decides on sparse or dense base on number of nonzeros in the active vertices.
 template <class data, class vertex, class VS, class F>
-vertexSubsetData<data> bfsEdgeMapData(graph<vertex> &GA, VS &vs, F f,
+vertexSubsetData<data> edgeMapData(graph<vertex> &GA, VS &vs, F f,
                                    intT threshold = -1, const flags &fl = 0)
 {
-  //printf("bfs EdgeMapData!\n");
-  //似乎Ligra有一个优化机制，可以查看subset里得非零点得数量,这个numNonzeros就是
-  long numVertices = GA.n, numEdges = GA.m, m = vs.numNonzeros();
   //如论文所说，除20就是threshold
   if (threshold == -1)
-    threshold = numEdges / 20; // default threshold
-  vertex *G = GA.V;
-  if (numVertices != vs.numRows())
-  {
-    cout << "edgeMap: Sizes Don't match" << endl;
-    abort();
-  }
-  //printf("step1!\n");
-  //这里只传递了一个num，所以返回的subset肯定是空的
-  if (m == 0){
-    vertexSubsetData<data> ret = vertexSubsetData<data>(numVertices);
-    ret.setD(vs.getD(),vs.getD_size());
-    ret.setS(vs.getS(),vs.getS_size());
-    return ret;
-  }
-    
-  //所以这两个都是临时数据结构，都是要free掉的。
-  uintT *degrees = NULL;
-  vertex *frontierVertices = NULL;
-  uintT outDegrees = 0;
-  //printf("step2!\n");
-
-  if (threshold > 0)
-  { // compute sum of out-degrees if threshold > 0
-    vs.toSparse();
-    //[内存]新建一块连续区域，存放degree？
-    degrees = newA(uintT, m);
-    //[内存]frontier也被新建了
-    frontierVertices = newA(vertex, m);
-    {
-      parallel_for(size_t i = 0; i < m; i++)
-      {
-        
-        //在subset里，使用连续数组记录这些点的id的
-        //[BFS]这里在对frontier做遍历，v_id就是frontier里的某一个vertex
-        uintE v_id = vs.vtx(i);
-        //原图的数据结构vertex里记录了该点的临边
-        vertex v = G[v_id];
-        //获取临边的数量，放入degree里。degree是一个int
-        degrees[i] = v.getOutDegree();
-        //vs是一个subsetVertex的对象，而frontierVertices是一个vertex*数组，名字相近但是类型不一样。
-        frontierVertices[i] = v;
-      }
-    }
-    outDegrees = sequence::plusReduce(degrees, m);
-    if (outDegrees == 0){
-      vertexSubsetData<data> ret = vertexSubsetData<data>(numVertices);
-      ret.setD(vs.getD(),vs.getD_size());
-      ret.setS(vs.getS(),vs.getS_size());
-      return ret;
-    }
-  }
-  //printf("step3!\n");
-  if (!(fl & no_dense) && m + outDegrees > threshold)
-  {
-    if (degrees)
-      free(degrees);
-    if (frontierVertices)
-      free(frontierVertices);
-    vs.toDense();
-  //printf("step3-1!\n");
-    if(fl & dense_forward){
-  //printf("step3-2!\n");
-      vertexSubsetData<data> ret = edgeMapDenseForward<data, vertex, VS, F>(GA, vs, f, fl);
-      ret.setD(vs.getD(),vs.getD_size());
-      ret.setS(vs.getS(),vs.getS_size());
-  //printf("step3-3!\n");
-      return ret;
-    }else {
-  //printf("step3-4!\n");
-      vertexSubsetData<data> ret = edgeMapDense<data, vertex, VS, F>(GA, vs, f, fl);
-      ret.setD(vs.getD(),vs.getD_size());
-      ret.setS(vs.getS(),vs.getS_size());
-  //printf("step3-5!\n");
-      return ret;
-    }
-    //return (fl & dense_forward) ? edgeMapDenseForward<data, vertex, VS, F>(GA, vs, f, fl) : edgeMapDense<data, vertex, VS, F>(GA, vs, f, fl);
-  }
-  else
-  {
-  //printf("step4!\n");
-    //通过frontierVertices这个vertex*数组，我们重新构造他们后继的subsetVertex，很合理。
-    if(should_output(fl) && fl & sparse_no_filter){
-      vertexSubsetData<data> ret = edgeMapSparse_no_filter<data, vertex, VS, F>(GA, frontierVertices, vs, degrees, vs.numNonzeros(), f, fl);
-      ret.setD(vs.getD(),vs.getD_size());
-      ret.setS(vs.getS(),vs.getS_size());
-      return ret;
-    }else {
-      vertexSubsetData<data> ret = edgeMapSparse<data, vertex, VS, F>(GA, frontierVertices, vs, degrees, vs.numNonzeros(), f, fl);
-      ret.setD(vs.getD(),vs.getD_size());
-      ret.setS(vs.getS(),vs.getS_size());
-      return ret;
-    }
-  //printf("step5!\n");
-    //通过frontierVertices这个vertex*数组，我们重新构造他们后继的subsetVertex，很合理。
-    auto vs_out =
-        (should_output(fl) && fl & sparse_no_filter) ? // only call snof when we output
-            edgeMapSparse_no_filter<data, vertex, VS, F>(GA, frontierVertices, vs, degrees, vs.numNonzeros(), f, fl)
-                                                     : edgeMapSparse<data, vertex, VS, F>(GA, frontierVertices, vs, degrees, vs.numNonzeros(), f, fl);
-  //printf("step6!\n");
-    vs_out.setD(vs.getD(), vs.getD_size());
-    vs_out.setS(vs.getS(), vs.getS_size());
-    free(degrees);
-    free(frontierVertices);
-    return vs_out;
-  }
+    threshold = GA.m / 20; // default threshold
+  thresholdPolicy dp(threshold);
+  return edgeMapData<data>(GA, vs, f, dp, fl);
 }
 
-
 // Regular edgeMap, where no extra data is stored per vertex.
 template <class vertex, class VS, class F>
 vertexSubset edgeMap(graph<vertex> &GA, VS &vs, F f,
@@ -477,11 +934,110 @@ vertexSubset edgeMap(graph<vertex> &GA, VS &vs, F f,
   return edgeMapData<pbbs::empty>(GA, vs, f, threshold, fl);
 }
 
-template <class vertex, class VS, class F>
-vertexSubset bfsEdgeMap(graph<vertex> &GA, VS &vs, F f,
-                     intT threshold = -1, const flags &fl = 0)
+template <class vertex, class VS, class F, class DP,
+          typename std::enable_if<std::is_class<DP>::value, int>::type = 0>
+vertexSubset edgeMap(graph<vertex> &GA, VS &vs, F f, DP &dp, const flags &fl = 0)
 {
-  return bfsEdgeMapData<pbbs::empty>(GA, vs, f, threshold, fl);
+  return edgeMapData<pbbs::empty>(GA, vs, f, dp, fl);
+}
+
+// Keeps the vertices v of V for which p(v) is true, calling p once per
+// vertex and reusing V's storage.
+template <class vertex, class P>
+void filterInPlace(graph<vertex> &GA, vertexSubset &V, P &p)
+{
+  long n = V.numRows();
+  if (V.isEmpty())
+    return;
+  if (!V.dense())
+  {
+    uintE *tmp = GA.getPool()->template getScratch<uintE>(frontierPool::packed_slot, V.m);
+    auto pred = [&](uintE &v)
+    { return p(v); };
+    V.m = pbbs::filterf(V.s, tmp, V.m, pred);
+    parallel_for(size_t i = 0; i < V.m; i++) V.s[i] = tmp[i];
+  }
+  else if (V.d != NULL)
+  {
+    bool *d = V.d;
+    parallel_for(long v = 0; v < n; v++)
+    {
+      if (d[v])
+        d[v] = p(v);
+    }
+    V.m = pbbs::reduce_add(make_in_imap<size_t>(n, [&](size_t i)
+                                                { return (size_t)d[i]; }));
+  }
+  else
+  {
+    uint64_t *bits = V.bits;
+    size_t nw = bitmapWords(n);
+    parallel_for(size_t w = 0; w < nw; w++)
+    {
+      uint64_t word = 0;
+      bitmapForWord(bits[w], w, [&](size_t v)
+                    { if (p(v)) word |= ((uint64_t)1) << (v & 63); });
+      bits[w] = word;
+    }
+    V.m = bitmapCount(bits, n);
+  }
+}
+
+// edgeMap fused with the vertexMap/vertexFilter that usually follows it.
+// apply(v) runs once for each vertex v an update returned true for, after
+// all of v's updates, and the result holds the v for which apply returned
+// true. With apply_all, apply runs on every vertex instead (PageRank-style
+// sweeps). In a pull (dense without dense_forward) apply runs right after
+// v's in-edges are processed, which saves a pass over the vertices;
+// otherwise it runs in a pass over the edgeMap's output (over all vertices
+// with apply_all).
+template <class vertex, class VS, class F, class A>
+vertexSubset edgeMapApply(graph<vertex> &GA, VS &vs, F f, A apply,
+                          intT threshold = -1, const flags &fl = 0)
+{
+  if (threshold == -1)
+    threshold = GA.m / 20;
+  thresholdPolicy dp(threshold);
+  applyStep<A> ap(apply, fl);
+  frontierPool *pool = GA.getPool();
+  int parity = pool->cur;
+  // The edgeMap's own output is only needed to know where to apply.
+  flags inner = (fl & apply_all) ? (fl | no_output) : (fl & ~no_output);
+  vertexSubset out = edgeMapDataApply<pbbs::empty>(GA, vs, f, dp, inner, ap);
+  if (ap.applied)
+    return out;
+  long n = GA.n;
+  if (fl & apply_all)
+  {
+    bool *next = NULL;
+    if (should_output(fl) && (fl & reuse_frontier))
+    {
+      // The output takes the pool's next parity, unless edgeMapDataApply
+      // returned early and did not flip.
+      if (pool->cur == parity)
+        pool->flip();
+      next = pool->curDense<bool>(n);
+    }
+    else if (should_output(fl))
+      next = newA(bool, n);
+    parallel_for(long v = 0; v < n; v++)
+    {
+      bool keep = apply(v);
+      if (next != NULL)
+        next[v] = keep;
+    }
+    vertexSubset res = (next != NULL) ? vertexSubset(n, next) : vertexSubset(n);
+    if (fl & reuse_frontier)
+      res.borrow();
+    return res;
+  }
+  filterInPlace(GA, out, apply);
+  if (!should_output(fl))
+  {
+    out.del();
+    return vertexSubset(n);
+  }
+  return out;
 }
 
 // Packs out the adjacency lists of all vertex in vs. A neighbor, ngh, is kept
@@ -524,6 +1080,7 @@ vertexSubsetData<uintE> packEdges(graph<vertex> &GA, vertexSubset &vs, P &p, con
       auto tmp1Off = &(tmp1[offset]);
       auto tmp2Off = &(tmp2[offset]);
       size_t ct = G[v].packOutNgh(v, p, bitsOff, tmp1Off, tmp2Off);
+      GA.numaSync(v);
       outV[i] = make_tuple(v, ct);
     }
   }
@@ -537,6 +1094,7 @@ vertexSubsetData<uintE> packEdges(graph<vertex> &GA, vertexSubset &vs, P &p, con
       auto tmp1Off = &(tmp1[offset]);
       auto tmp2Off = &(tmp2[offset]);
       size_t ct = G[v].packOutNgh(v, p, bitsOff, tmp1Off, tmp2Off);
+      GA.numaSync(v);
     }
   }
   free(bits);
@@ -629,7 +1187,17 @@ template <class VS, class F, typename std::enable_if<std::is_same<VS, vertexSubs
 void vertexMap(VS &V, F f)
 {
   size_t n = V.numRows(), m = V.numNonzeros();
-  if (V.dense())
+  if (V.dense() && V.d == NULL)
+  {
+    uint64_t *bits = V.bits;
+    size_t nw = bitmapWords(n);
+    parallel_for(size_t w = 0; w < nw; w++)
+    {
+      if (bits[w])
+        bitmapForWord(bits[w], w, [&](size_t i) { f(i); });
+    }
+  }
+  else if (V.dense())
   {
     parallel_for(long i = 0; i < n; i++)
     {
@@ -726,6 +1294,16 @@ void Compute(graph<vertex> &, commandLine);
 template <class vertex>
 void Compute(hypergraph<vertex> &, commandLine);
 
+// Vertex types of uncompressed graphs. With -DCSR the vertex array is just
+// the CSR offsets (see csrVertex.h).
+#ifdef CSR
+typedef csrSymmetricVertex uncompressedSymmetricVertex;
+typedef csrAsymmetricVertex uncompressedAsymmetricVertex;
+#else
+typedef symmetricVertex uncompressedSymmetricVertex;
+typedef asymmetricVertex uncompressedAsymmetricVertex;
+#endif
+
 int parallel_main(int argc, char *argv[])
 {
   commandLine P(argc, argv, " [-s] <inFile>");
@@ -736,6 +1314,30 @@ int parallel_main(int argc, char *argv[])
   bool mmap = P.getOptionValue("-m");
   // cout << "mmap = " << mmap << endl;
   long rounds = P.getOptionLongValue("-rounds", 1);
+  pool_huge_pages = P.getOption("-hugepool");
+  dense_edge_grain = P.getOptionLongValue("-edgegrain", dense_edge_grain);
+  sparse_hub_grain = P.getOptionLongValue("-hubgrain", sparse_hub_grain);
+  string pages = P.getOptionValue("-pages", page_kind_names[page_policy]);
+  if (!parsePageKind(pages.c_str(), page_policy))
+  {
+    cout << "unknown -pages " << pages << " (use 4k, thp, 2m or 1g)" << endl;
+    abort();
+  }
+  page_strict = P.getOption("-pagestrict");
+  page_prefault = P.getOption("-prefault");
+  // -numa places the graph and app arrays over the NUMA nodes and runs the
+  // dense edgeMaps node by node (see numaPlace.h); -numanodes k pretends
+  // there are k nodes.
+  numa_enabled = P.getOption("-numa") || P.getOption("-numanodes");
+  numa_fake_nodes = P.getOptionIntValue("-numanodes", 0);
+  // -memmap {csv,json} reports where the graph and app arrays ended up, once
+  // the last round has run (see memMap.h).
+  string memmap = P.getOptionValue("-memmap", "");
+  if (memmap != "" && memmap != "csv" && memmap != "json")
+  {
+    cout << "unknown -memmap " << memmap << " (use csv or json)" << endl;
+    abort();
+  }
   //注意这里运用compressed参数才会进来这里，不然到下面那个else看看吧
   if (compressed)
   {
@@ -755,6 +1357,8 @@ int parallel_main(int argc, char *argv[])
         Compute(G, P);
         nextTime("Running time");
       }
+      if (memmap != "")
+        memMapReport(cout, memmap == "json");
       G.del();
     }
     else
@@ -777,6 +1381,8 @@ int parallel_main(int argc, char *argv[])
         if (G.transposed)
           G.transpose();
       }
+      if (memmap != "")
+        memMapReport(cout, memmap == "json");
       G.del();
     }
   }
@@ -786,8 +1392,8 @@ int parallel_main(int argc, char *argv[])
     {
 #ifndef HYPER
       //[BFS]我们会用到symmetricVertex
-      graph<symmetricVertex> G =
-          readGraph<symmetricVertex>(iFile, compressed, symmetric, binary, mmap); // symmetric graph
+      graph<uncompressedSymmetricVertex> G =
+          readGraph<uncompressedSymmetricVertex>(iFile, compressed, symmetric, binary, mmap); // symmetric graph
 #else
       hypergraph<symmetricVertex> G =
           readHypergraph<symmetricVertex>(iFile, compressed, symmetric, binary, mmap); // symmetric graph
@@ -799,13 +1405,15 @@ int parallel_main(int argc, char *argv[])
         Compute(G, P);
         nextTime("Running time");
       }
+      if (memmap != "")
+        memMapReport(cout, memmap == "json");
       G.del();
     }
     else
     {
 #ifndef HYPER
-      graph<asymmetricVertex> G =
-          readGraph<asymmetricVertex>(iFile, compressed, symmetric, binary, mmap); // asymmetric graph
+      graph<uncompressedAsymmetricVertex> G =
+          readGraph<uncompressedAsymmetricVertex>(iFile, compressed, symmetric, binary, mmap); // asymmetric graph
 #else
       hypergraph<asymmetricVertex> G =
           readHypergraph<asymmetricVertex>(iFile, compressed, symmetric, binary, mmap); // asymmetric graph
@@ -821,8 +1429,12 @@ int parallel_main(int argc, char *argv[])
         if (G.transposed)
           G.transpose();
       }
+      if (memmap != "")
+        memMapReport(cout, memmap == "json");
       G.del();
     }
   }
+  if (P.getOption("-pagestats"))
+    pageReport(cout);
 }
 #endif
@@ -0,0 +1,138 @@
+// Memory placement report for the regions allocated by pageAlloc (see
+// pageAlloc.h), selected with -memmap {csv,json} (see parallel_main in
+// ligra.h) or produced by calling memMapReport directly. Nothing is read
+// unless a report is asked for.
+//
+// One report reads /proc/self/pagemap once, in large batches, over every
+// live region and prints per region: its virtual range, page kind and NUMA
+// placement, the number of resident 4KB pages, how many of its 2MB windows
+// are backed by a single huge page, the number of physically contiguous
+// runs, and how many 2MB windows sit on each NUMA node. Physical frame numbers are only shown
+// to privileged processes; without them the huge page and run counts are
+// reported as -1.
+#ifndef MEM_MAP_H
+#define MEM_MAP_H
+#include <stdint.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <iostream>
+#include <map>
+#include <vector>
+#include "pageAlloc.h"
+
+struct memMapEntry {
+  uintptr_t start;
+  pageRegion region;
+  long resident;           // 4KB pages present
+  long huge;               // 2MB windows backed by one huge page, or -1
+  long extents;            // physically contiguous runs, or -1
+  std::map<int, long> nodes; // 2MB windows (with a resident page) per node
+};
+
+// Fills in the counts of e from the pagemap file fd.
+inline void memMapScan(int fd, memMapEntry& e) {
+  const long ps = 4096, window = 512; // 4KB pages per 2MB window
+  const long batch = 1 << 16;
+  e.resident = 0; e.huge = 0; e.extents = 0;
+  if (e.region.bytes == 0) return;
+  long first = e.start / ps, last = (e.start + e.region.bytes - 1) / ps;
+  std::vector<uint64_t> buf(batch);
+  std::vector<void*> samples; // first resident page of each window
+  bool pfnKnown = false, inRun = false;
+  uint64_t prevPfn = 0, winPfn = 0;
+  long winPresent = 0, winIndex = -1;
+  bool winContig = false;
+  for (long b = first; b <= last; b += batch) {
+    long cnt = std::min(batch, last + 1 - b);
+    ssize_t got = pread(fd, buf.data(), cnt * sizeof(uint64_t), b * sizeof(uint64_t));
+    if (got != (ssize_t)(cnt * sizeof(uint64_t))) { e.huge = e.extents = -1; return; }
+    for (long j = 0; j < cnt; j++) {
+      long page = b + j;
+      if (page / window != winIndex) {
+        if (winPresent == window && winContig && winPfn % window == 0) e.huge++;
+        winIndex = page / window; winPresent = 0; winContig = true;
+      }
+      uint64_t item = buf[j];
+      bool present = (item >> 63) & 1;
+      uint64_t pfn = item & (((uint64_t)1 << 55) - 1);
+      if (!present) { inRun = false; winContig = false; continue; }
+      if (pfn != 0) pfnKnown = true;
+      e.resident++;
+      if (!inRun || pfn != prevPfn + 1) e.extents++;
+      if (winPresent == 0) {
+        winPfn = pfn;
+        samples.push_back((void*)(page * ps));
+        if (page % window != 0) winContig = false;
+      } else if (pfn != prevPfn + 1) winContig = false;
+      winPresent++;
+      inRun = true; prevPfn = pfn;
+    }
+  }
+  if (winPresent == window && winContig && winPfn % window == 0) e.huge++;
+  if (!pfnKnown && e.resident > 0) e.huge = e.extents = -1;
+#ifdef SYS_move_pages
+  // With no target nodes, move_pages only reports where each page is.
+  std::vector<int> status(samples.size());
+  for (size_t i = 0; i < samples.size(); i += batch) {
+    long cnt = std::min((size_t)batch, samples.size() - i);
+    if (syscall(SYS_move_pages, 0, cnt, samples.data() + i, NULL,
+                status.data() + i, 0) != 0) return;
+    for (long j = 0; j < cnt; j++)
+      if (status[i + j] >= 0) e.nodes[status[i + j]]++;
+  }
+#endif
+}
+
+// Prints the placement of every live pageAlloc region, as CSV (one header
+// line, then one line per region) or as a JSON object.
+inline void memMapReport(std::ostream& os, bool json) {
+  pageRegistry& r = pageRegions();
+  std::vector<memMapEntry> entries;
+  r.acquire();
+  for (auto it = r.regions.begin(); it != r.regions.end(); it++) {
+    memMapEntry e;
+    e.start = it->first; e.region = it->second;
+    entries.push_back(e);
+  }
+  r.release();
+  int fd = open("/proc/self/pagemap", O_RDONLY);
+  for (size_t i = 0; i < entries.size(); i++) {
+    if (fd >= 0) memMapScan(fd, entries[i]);
+    else entries[i].resident = entries[i].huge = entries[i].extents = -1;
+  }
+  if (fd >= 0) close(fd);
+
+  if (json) os << "{\"regions\": [";
+  else os << "region,start,end,bytes,kind,want,place,resident_4k,huge_2m,extents,nodes" << std::endl;
+  for (size_t i = 0; i < entries.size(); i++) {
+    memMapEntry& e = entries[i];
+    char range[64];
+    snprintf(range, sizeof(range), json ? "\"0x%lx\", \"end\": \"0x%lx\"" : "0x%lx,0x%lx",
+             (unsigned long)e.start, (unsigned long)(e.start + e.region.bytes));
+    if (json) {
+      os << (i ? ",\n  " : "\n  ") << "{\"region\": \"" << e.region.name
+         << "\", \"start\": " << range << ", \"bytes\": " << e.region.bytes
+         << ", \"kind\": \"" << page_kind_names[e.region.kind]
+         << "\", \"want\": \"" << page_kind_names[e.region.want]
+         << "\", \"place\": \"" << numa_mode_names[e.region.place]
+         << "\", \"resident_4k\": " << e.resident << ", \"huge_2m\": " << e.huge
+         << ", \"extents\": " << e.extents << ", \"nodes\": {";
+      for (auto it = e.nodes.begin(); it != e.nodes.end(); it++)
+        os << (it == e.nodes.begin() ? "" : ", ") << "\"" << it->first << "\": " << it->second;
+      os << "}}";
+    } else {
+      os << e.region.name << "," << range << "," << e.region.bytes << ","
+         << page_kind_names[e.region.kind] << "," << page_kind_names[e.region.want] << ","
+         << numa_mode_names[e.region.place] << ","
+         << e.resident << "," << e.huge << "," << e.extents << ",";
+      for (auto it = e.nodes.begin(); it != e.nodes.end(); it++)
+        os << (it == e.nodes.begin() ? "" : ";") << it->first << ":" << it->second;
+      os << std::endl;
+    }
+  }
+  if (json) os << "\n]}" << std::endl;
+}
+
+#endif
@@ -0,0 +1,158 @@
+// Multi-source BFS. Up to 64*W breadth-first searches run together over a
+// shared frontier: every vertex keeps a mask of W 64-bit words with bit i set
+// once the search from sources[i] has reached it, and each round one edgeMap
+// ORs the masks of the frontier into their neighbors. A vertex is in the
+// frontier of round r iff some search reached it in round r-1, so each edge
+// scan serves all of the searches at once.
+//
+// For every (vertex, search) pair, the visit functor is called exactly once,
+// in the round in which the search first reaches the vertex, as
+//
+//   visit(uintE v, uintE parent, const sourceMask<W>& bits, intE level)
+//
+// where bits holds the searches reaching v through parent in that call. A
+// source is visited with level 0 and itself as parent. Calls for the same v
+// in the same round can run concurrently (on disjoint bits).
+#ifndef MULTI_BFS_H
+#define MULTI_BFS_H
+#include <stdint.h>
+#include "ligra.h"
+
+// The searches a vertex has been reached by. W is 1, 2 or 4 (64, 128 or 256
+// searches); the word loops are unrolled and vectorized by the compiler.
+template <long W>
+struct sourceMask {
+  uint64_t w[W];
+
+  inline void clear() { for (long j = 0; j < W; j++) w[j] = 0; }
+  inline void set(long i) { w[i >> 6] |= (uint64_t)1 << (i & 63); }
+  inline bool get(long i) const { return (w[i >> 6] >> (i & 63)) & 1; }
+  inline bool any() const {
+    uint64_t r = 0;
+    for (long j = 0; j < W; j++) r |= w[j];
+    return r != 0;
+  }
+  // *this = a & ~b; returns any().
+  inline bool diff(const sourceMask& a, const sourceMask& b) {
+    for (long j = 0; j < W; j++) w[j] = a.w[j] & ~b.w[j];
+    return any();
+  }
+  // Calls g(i) for every set bit i.
+  template <class G>
+  inline void forEach(G g) const {
+    for (long j = 0; j < W; j++)
+      for (uint64_t x = w[j]; x; x &= x - 1)
+        g(j * 64 + __builtin_ctzll(x));
+  }
+};
+
+// Visit functor that does nothing.
+struct multiBFS_noVisit {
+  template <class M>
+  inline void operator() (uintE v, uintE parent, const M& bits, intE level) {}
+};
+
+// Visit functor recording, for search i and vertex v, the BFS level and
+// parent in level[v*k+i] and parent[v*k+i] (either may be NULL). Entries of
+// pairs that are never reached are left untouched.
+struct multiBFS_record {
+  intE* level;
+  uintE* parent;
+  long k;
+  multiBFS_record(intE* _level, uintE* _parent, long _k) :
+    level(_level), parent(_parent), k(_k) {}
+  template <class M>
+  inline void operator() (uintE v, uintE p, const M& bits, intE l) {
+    long o = (long)v * k;
+    bits.forEach([&] (long i) {
+      if (level != NULL) level[o + i] = l;
+      if (parent != NULL) parent[o + i] = p;
+    });
+  }
+};
+
+template <long W, class Visit>
+struct multiBFS_F {
+  sourceMask<W>* visited, *next;
+  intE* stamp; // last round in which the vertex was reached
+  intE round;
+  Visit visit;
+  multiBFS_F(sourceMask<W>* _visited, sourceMask<W>* _next, intE* _stamp,
+             intE _round, Visit _visit) :
+    visited(_visited), next(_next), stamp(_stamp), round(_round), visit(_visit) {}
+  inline bool update (uintE s, uintE d) {
+    sourceMask<W> add;
+    if (!add.diff(visited[s], visited[d])) return 0;
+    if (!add.diff(add, next[d])) return 0;
+    for (long j = 0; j < W; j++) next[d].w[j] |= add.w[j];
+    visit(d, s, add, round);
+    if (stamp[d] != round) { stamp[d] = round; return 1; }
+    return 0;
+  }
+  inline bool updateAtomic (uintE s, uintE d) {
+    sourceMask<W> add;
+    if (!add.diff(visited[s], visited[d])) return 0;
+    // Keep only the bits this call sets, so that each (d, search) pair is
+    // visited once.
+    for (long j = 0; j < W; j++)
+      if (add.w[j]) add.w[j] &= ~__sync_fetch_and_or(&next[d].w[j], add.w[j]);
+    if (!add.any()) return 0;
+    visit(d, s, add, round);
+    intE old = stamp[d];
+    return old != round && CAS(&stamp[d], old, round);
+  }
+  inline bool cond (uintE d) { return cond_true(d); }
+};
+
+// Publishes the bits gained in the last round to visited.
+template <long W>
+struct multiBFS_Sync {
+  sourceMask<W>* visited, *next;
+  multiBFS_Sync(sourceMask<W>* _visited, sourceMask<W>* _next) :
+    visited(_visited), next(_next) {}
+  inline bool operator() (uintE i) {
+    visited[i] = next[i];
+    return 1;
+  }
+};
+
+// Runs the k <= 64*W searches from sources[0..k) (duplicates allowed) and
+// returns the number of levels, i.e. the largest distance from a source to
+// a vertex it reaches. fl is passed to every edgeMap.
+template <long W, class vertex, class Visit>
+intE multiBFS(graph<vertex>& GA, uintE* sources, long k, Visit visit,
+              const flags& fl = 0) {
+  typedef sourceMask<W> mask;
+  long n = GA.n;
+  k = min(k, 64 * W);
+  mask* visited = newA(mask, n), *next = newA(mask, n);
+  intE* stamp = newA(intE, n);
+  {parallel_for(long i = 0; i < n; i++) {
+    visited[i].clear(); next[i].clear(); stamp[i] = -1;
+  }}
+  uintE* starts = newA(uintE, k);
+  long m = 0;
+  for (long i = 0; i < k; i++) {
+    uintE v = sources[i];
+    if (!next[v].any()) starts[m++] = v;
+    next[v].set(i);
+    mask one; one.clear(); one.set(i);
+    visit(v, v, one, 0);
+    stamp[v] = 0;
+  }
+
+  vertexSubset Frontier(n, m, starts);
+  intE round = 0;
+  while (!Frontier.isEmpty()) {
+    round++;
+    vertexMap(Frontier, multiBFS_Sync<W>(visited, next));
+    vertexSubset output =
+      edgeMap(GA, Frontier, multiBFS_F<W, Visit>(visited, next, stamp, round, visit), -1, fl);
+    Frontier.del();
+    Frontier = output;
+  }
+  Frontier.del(); free(visited); free(next); free(stamp);
+  return max(0, round - 1);
+}
+
+#endif
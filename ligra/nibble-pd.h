@@ -104,31 +104,35 @@ inline uintE decode_next_edge(uchar* &start, long* location) {
 /*
   The main decoding work-horse. First eats the specially coded first
   edge, and then eats the remaining |d-1| many edges that are normally
-  coded.
+  coded. Only the chunks of PARALLEL_DEGREE edges in [chunkLo, chunkHi)
+  are decoded (by default all of them).
 */
 template <class T>
-  inline void decode(T t, uchar* edgeStart, const uintE &source, const uintT &degree, const bool par=true) {
+  inline void decode(T t, uchar* edgeStart, const uintE &source, const uintT &degree, const bool par=true,
+                     long chunkLo=0, long chunkHi=LONG_MAX) {
   if (degree > 0) {
     long numChunks = 1+(degree-1)/PARALLEL_DEGREE;
     uintE* pOffsets = (uintE*) edgeStart; //use beginning of edgeArray for offsets into edge list
     uchar* start = edgeStart + (numChunks-1)*sizeof(uintE);
     //do first chunk
     long end = min<long>(PARALLEL_DEGREE,degree);
-    long location = 0;
-    // Eat first edge, which is compressed specially
+    if (chunkLo == 0) {
+      long location = 0;
+      // Eat first edge, which is compressed specially
 
-    uintE startEdge = decode_first_edge(start,&location,source);
+      uintE startEdge = decode_first_edge(start,&location,source);
 
-    if(!t.srcTarg(source,startEdge,0)) return;
-    for (uintE edgeID = 1; edgeID < end; edgeID++) {
-      // Eat the next 'edge', which is a difference, and reconstruct edge.
-      uintE edgeRead = decode_next_edge(start,&location);
-      uintE edge = startEdge + edgeRead;
-      startEdge = edge;
-      if(!t.srcTarg(source,startEdge,edgeID)) return;
+      if(!t.srcTarg(source,startEdge,0)) return;
+      for (uintE edgeID = 1; edgeID < end; edgeID++) {
+	// Eat the next 'edge', which is a difference, and reconstruct edge.
+	uintE edgeRead = decode_next_edge(start,&location);
+	uintE edge = startEdge + edgeRead;
+	startEdge = edge;
+	if(!t.srcTarg(source,startEdge,edgeID)) return;
+      }
     }
     //do remaining chunks in parallel
-    granular_for(i, 1, numChunks, par, {
+    granular_for(i, max(1L,chunkLo), min(numChunks,chunkHi), par, {
       long o = i*PARALLEL_DEGREE;
       long end = min<long>(o+PARALLEL_DEGREE,degree);
       // Eat first edge, which is compressed specially
@@ -148,28 +152,31 @@ template <class T>
 
 //decode edges for weighted graph
 template <class T>
-  inline void decodeWgh(T t, uchar* edgeStart, const uintE &source,const uintT &degree, const bool par=true) {
+  inline void decodeWgh(T t, uchar* edgeStart, const uintE &source,const uintT &degree, const bool par=true,
+                     long chunkLo=0, long chunkHi=LONG_MAX) {
   if(degree > 0){
     long numChunks = 1+(degree-1)/PARALLEL_DEGREE;
     uintE* pOffsets = (uintE*) edgeStart; //use beginning of edgeArray for offsets into edge list
     uchar* start = edgeStart + (numChunks-1)*sizeof(uintE);
     //do first chunk
     long end = min<long>(PARALLEL_DEGREE,degree);
-    long location = 0;
-    // Eat first edge, which is compressed specially
-    uintE startEdge = decode_first_edge(start,&location,source);
-    intE weight = decode_first_edge(start,&location,0);
-    if(!t.srcTarg(source,startEdge,weight,0)) return;
-    for (uintE edgeID = 1; edgeID < end; edgeID++) {
-      // Eat the next 'edge', which is a difference, and reconstruct edge.
-      uintE edgeRead = decode_next_edge(start,&location);
-      uintE edge = startEdge + edgeRead;
-      startEdge = edge;
+    if (chunkLo == 0) {
+      long location = 0;
+      // Eat first edge, which is compressed specially
+      uintE startEdge = decode_first_edge(start,&location,source);
       intE weight = decode_first_edge(start,&location,0);
-      if(!t.srcTarg(source,startEdge,weight,edgeID)) return;
+      if(!t.srcTarg(source,startEdge,weight,0)) return;
+      for (uintE edgeID = 1; edgeID < end; edgeID++) {
+	// Eat the next 'edge', which is a difference, and reconstruct edge.
+	uintE edgeRead = decode_next_edge(start,&location);
+	uintE edge = startEdge + edgeRead;
+	startEdge = edge;
+	intE weight = decode_first_edge(start,&location,0);
+	if(!t.srcTarg(source,startEdge,weight,edgeID)) return;
+      }
     }
     //do remaining chunks in parallel
-    granular_for(i, 1, numChunks, par, {
+    granular_for(i, max(1L,chunkLo), min(numChunks,chunkHi), par, {
       long o = i*PARALLEL_DEGREE;
       long end = min<long>(o+PARALLEL_DEGREE,degree);
       long location = pOffsets[i-1];
@@ -0,0 +1,135 @@
+// NUMA placement for the arrays allocated by pageAlloc (see pageAlloc.h),
+// turned on with -numa (see parallel_main in ligra.h). Each region is given
+// one of the placements below when it is allocated:
+//
+//   numa_local       the kernel default: pages go to the node that first
+//                    writes them
+//   numa_interleave  pages are spread round-robin over all nodes (the graph
+//                    edges, which every node reads at random)
+//   numa_partition   the region is cut into one contiguous block per node,
+//                    block k on node k (per-vertex app state and dense
+//                    frontiers; numaRange gives the matching vertex ranges,
+//                    over which the dense edgeMap loops run)
+//   numa_replicate   the region is placed on one given node; a read-mostly
+//                    array gets one such copy per node (the vertex array)
+//
+// The policies are set with mbind before any page is touched. On a machine
+// with a single node (or without -numa) numaNodes() is 1 and all of this is
+// skipped. -numanodes k pretends there are k nodes, so that the partitioned
+// loops and the replicas can be exercised on any machine; binding to nodes
+// that do not exist fails and is ignored.
+#ifndef NUMA_PLACE_H
+#define NUMA_PLACE_H
+#include <stdio.h>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <vector>
+
+enum numaMode { numa_local, numa_interleave, numa_partition, numa_replicate, num_numa_modes };
+
+static const char* const numa_mode_names[num_numa_modes] =
+  {"local", "interleave", "partition", "replicate"};
+
+static bool numa_enabled = false;
+static int numa_fake_nodes = 0;
+// Node the current worker last ran a partitioned loop on; selects its
+// replicas.
+static __thread int numa_this_node = 0;
+
+struct numaTopology {
+  int nodes;
+  std::vector<int> cpuNode; // node of each cpu
+};
+
+// Reads the nodes and their cpus from /sys; one node if that fails.
+inline numaTopology readNumaTopology() {
+  numaTopology t;
+  t.nodes = 0;
+  for (int k = 0; ; k++) {
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", k);
+    FILE* f = fopen(path, "r");
+    if (f == NULL) break;
+    int lo, hi;
+    while (fscanf(f, "%d", &lo) == 1) {
+      hi = lo;
+      int c = fgetc(f);
+      if (c == '-') { if (fscanf(f, "%d", &hi) != 1) break; c = fgetc(f); }
+      if (hi >= (int)t.cpuNode.size()) t.cpuNode.resize(hi + 1, 0);
+      for (int cpu = lo; cpu <= hi; cpu++) t.cpuNode[cpu] = k;
+      if (c != ',') break;
+    }
+    fclose(f);
+    t.nodes = k + 1;
+  }
+  if (t.nodes == 0) t.nodes = 1;
+  return t;
+}
+
+inline numaTopology& numaTopo() {
+  static numaTopology t = readNumaTopology();
+  return t;
+}
+
+// Number of nodes placement spreads over; 1 unless -numa is given.
+inline int numaNodes() {
+  if (!numa_enabled) return 1;
+  return numa_fake_nodes > 0 ? numa_fake_nodes : numaTopo().nodes;
+}
+
+// Node of the cpu the calling thread is running on.
+inline int numaCurrentNode() {
+  int nodes = numaNodes();
+  if (nodes <= 1) return 0;
+  int cpu = sched_getcpu();
+  if (cpu < 0) return 0;
+  if (numa_fake_nodes > 0) return cpu % nodes;
+  numaTopology& t = numaTopo();
+  return (cpu < (int)t.cpuNode.size()) ? t.cpuNode[cpu] : 0;
+}
+
+// Start of the part of [0, n) that partition placement puts on node k,
+// a multiple of 64 so that bitmap words are not split.
+inline long numaRange(long n, int k) {
+  int nodes = numaNodes();
+  if (k >= nodes) return n;
+  return ((n * k / nodes) / 64) * 64;
+}
+
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED 1
+#endif
+#ifndef MPOL_INTERLEAVE
+#define MPOL_INTERLEAVE 3
+#endif
+
+// Sets the memory policy of the whole pages of [p, p+bytes); page is the
+// page size of the mapping. Failures leave the kernel default in place.
+inline void numaBindRange(char* p, size_t bytes, size_t page, int mode, int node) {
+#ifdef SYS_mbind
+  uintptr_t lo = ((uintptr_t)p + page - 1) / page * page;
+  uintptr_t hi = ((uintptr_t)p + bytes) / page * page;
+  if (hi <= lo) return;
+  int nodes = numaNodes();
+  std::vector<unsigned long> mask(nodes / 64 + 1, 0);
+  for (int k = 0; k < nodes; k++)
+    if (mode == MPOL_INTERLEAVE || k == node) mask[k / 64] |= 1UL << (k % 64);
+  syscall(SYS_mbind, lo, hi - lo, mode, mask.data(), mask.size() * 64 + 1, 0);
+#endif
+}
+
+// Applies placement m to a fresh region; node is the target of a replica.
+inline void numaPlace(void* p, size_t bytes, size_t page, numaMode m, int node) {
+  int nodes = numaNodes();
+  if (nodes <= 1 || m == numa_local) return;
+  char* c = (char*) p;
+  if (m == numa_interleave) numaBindRange(c, bytes, page, MPOL_INTERLEAVE, 0);
+  else if (m == numa_replicate) numaBindRange(c, bytes, page, MPOL_PREFERRED, node);
+  else
+    for (int k = 0; k < nodes; k++) {
+      size_t lo = bytes * k / nodes, hi = bytes * (k + 1) / nodes;
+      numaBindRange(c + lo, hi - lo, page, MPOL_PREFERRED, k);
+    }
+}
+#endif
@@ -0,0 +1,202 @@
+// Page-size policy for large allocations, selected at run time with
+// -pages {4k,thp,2m,1g} (see parallel_main in ligra.h); the default is 2m.
+//
+// pageAlloc(bytes, name) serves the big named arrays (graph storage, app
+// state, frontier pool buffers) with pages of the policy's kind: explicit
+// 1GB or 2MB hugetlb pages, transparent huge pages (2MB-aligned memory
+// advised with MADV_HUGEPAGE) or plain malloc. When a kind cannot be had
+// (e.g. the hugetlb pool is exhausted) the next smaller one is tried, and
+// the fallback is counted, unless -pagestrict is given, in which case the
+// program aborts. Memory from pageAlloc must be released with pageFree,
+// which also accepts memory from newA. Every allocation is recorded with
+// its name, size and page kind, and -pagestats prints the totals.
+//
+// The first write to a page decides which NUMA node backs it. The loaders
+// fill their arrays in parallel so that pages land next to the threads that
+// use them; with -prefault, pageAlloc also touches every page of a new
+// region from a parallel loop before returning it, so that no page faults
+// are left for the timed rounds. With -numa, each region also gets a NUMA
+// placement (see numaPlace.h), set before its first page is touched.
+//
+// newA itself stays malloc-compatible (its memory may be passed to free):
+// with any policy other than 4k, arrays of 2MB or more are 2MB-aligned and
+// advised for transparent huge pages.
+#ifndef PAGE_ALLOC_H
+#define PAGE_ALLOC_H
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <sys/mman.h>
+#include "parallel.h"
+#include "numaPlace.h"
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+#ifndef MAP_HUGE_1GB
+#define MAP_HUGE_1GB (30 << MAP_HUGE_SHIFT)
+#endif
+
+// Ordered by page size: a failed kind falls back to the one before it.
+enum pageKind { page_small, page_thp, page_huge_2m, page_huge_1g, num_page_kinds };
+
+static const char* const page_kind_names[num_page_kinds] = {"4k", "thp", "2m", "1g"};
+static const size_t page_kind_bytes[num_page_kinds] = {4096, 2097152, 2097152, 1073741824};
+
+static pageKind page_policy = page_huge_2m;
+static bool page_strict = false;
+static bool page_prefault = false;
+// Smallest newA allocation that is given transparent huge pages.
+static const size_t page_thp_min = 2097152;
+
+// Parses a -pages value; returns false if s names no page kind.
+inline bool parsePageKind(const char* s, pageKind& k) {
+  for (int i = 0; i < num_page_kinds; i++)
+    if (strcmp(s, page_kind_names[i]) == 0) { k = (pageKind)i; return true; }
+  return false;
+}
+
+struct pageRegion {
+  const char* name;
+  size_t bytes;   // requested
+  size_t mapped;  // rounded up to whole pages for hugetlb mappings
+  pageKind kind;  // the kind actually obtained
+  pageKind want;  // the kind asked for
+  numaMode place;
+};
+
+// All live pageAlloc regions, by start address, and the totals since start.
+struct pageRegistry {
+  std::map<uintptr_t, pageRegion> regions;
+  long count[num_page_kinds];
+  size_t bytes[num_page_kinds];
+  long fallbacks;
+  volatile int lock;
+  pageRegistry() : fallbacks(0), lock(0) {
+    for (int i = 0; i < num_page_kinds; i++) { count[i] = 0; bytes[i] = 0; }
+  }
+  void acquire() { while (__sync_lock_test_and_set(&lock, 1)) while (lock); }
+  void release() { __sync_lock_release(&lock); }
+};
+
+inline pageRegistry& pageRegions() {
+  static pageRegistry r;
+  return r;
+}
+
+// 2MB-aligned memory advised for transparent huge pages, or NULL.
+inline void* allocTHP(size_t bytes) {
+  size_t b = page_kind_bytes[page_thp];
+  void* p = NULL;
+  if (posix_memalign(&p, b, bytes) != 0) return NULL;
+#ifdef MADV_HUGEPAGE
+  madvise(p, ((bytes + b - 1) / b) * b, MADV_HUGEPAGE);
+#endif
+  return p;
+}
+
+// A hugetlb mapping of mapped bytes with pages of kind k, or NULL.
+inline void* mapHuge(size_t mapped, pageKind k) {
+  int sz = (k == page_huge_1g) ? MAP_HUGE_1GB : MAP_HUGE_2MB;
+  void* p = mmap(NULL, mapped, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | sz, -1, 0);
+  return (p == MAP_FAILED) ? NULL : p;
+}
+
+// Backs newA.
+inline void* pageMalloc(size_t bytes) {
+  if (page_policy == page_small || bytes < page_thp_min) return malloc(bytes);
+  void* p = allocTHP(bytes);
+  return (p != NULL) ? p : malloc(bytes);
+}
+
+// Writes one byte in every page of [p, p+bytes) from a parallel loop. The
+// stride is the page size of kind k, so a hugetlb region takes one fault per
+// huge page.
+inline void pageTouch(void* p, size_t bytes, pageKind k = page_small) {
+  char* c = (char*) p;
+  size_t stride = (k >= page_huge_2m) ? page_kind_bytes[k] : page_kind_bytes[page_small];
+  long pages = (bytes + stride - 1) / stride;
+  parallel_for(long i = 0; i < pages; i++) c[i * stride] = 0;
+}
+
+// place is the NUMA placement of the region under -numa; node is the node
+// of a numa_replicate region.
+inline void* pageAlloc(size_t bytes, const char* name, pageKind want = page_policy,
+                       numaMode place = numa_local, int node = 0) {
+  pageRegistry& r = pageRegions();
+  for (int k = want; k >= page_small; k--) {
+    size_t b = page_kind_bytes[k];
+    size_t mapped = (k >= page_huge_2m) ? ((bytes + b - 1) / b) * b : bytes;
+    void* p = (k == page_small) ? malloc(bytes)
+            : (k == page_thp) ? allocTHP(bytes)
+            : mapHuge(mapped, (pageKind)k);
+    if (p != NULL) {
+      pageRegion reg = {name, bytes, mapped, (pageKind)k, want, place};
+      r.acquire();
+      r.regions[(uintptr_t)p] = reg;
+      r.count[k]++; r.bytes[k] += bytes;
+      if (k != want) r.fallbacks++;
+      r.release();
+      numaPlace(p, bytes, (k >= page_huge_2m) ? b : page_kind_bytes[page_small], place, node);
+      if (page_prefault) pageTouch(p, bytes, (pageKind)k);
+      return p;
+    }
+    if (page_strict || k == page_small) {
+      std::cout << name << ": could not allocate " << bytes << " bytes with "
+                << page_kind_names[k] << " pages" << std::endl;
+      abort();
+    }
+  }
+  return NULL;
+}
+
+// Releases memory from pageAlloc or newA.
+inline void pageFree(void* p) {
+  if (p == NULL) return;
+  pageRegistry& r = pageRegions();
+  r.acquire();
+  auto it = r.regions.find((uintptr_t)p);
+  bool mapped = false;
+  size_t len = 0;
+  if (it != r.regions.end()) {
+    mapped = it->second.kind >= page_huge_2m;
+    len = it->second.mapped;
+    r.regions.erase(it);
+  }
+  r.release();
+  if (mapped) munmap(p, len);
+  else free(p);
+}
+
+// A copy of the bytes at src in a new region placed on node, filled from a
+// parallel loop.
+inline void* pageReplica(const void* src, size_t bytes, const char* name, int node) {
+  char* p = (char*) pageAlloc(bytes, name, page_policy, numa_replicate, node);
+  const char* s = (const char*) src;
+  const size_t block = 1 << 16;
+  long blocks = (bytes + block - 1) / block;
+  parallel_for(long i = 0; i < blocks; i++) {
+    size_t lo = i * block, len = std::min(block, bytes - lo);
+    memcpy(p + lo, s + lo, len);
+  }
+  return p;
+}
+
+// Prints how many allocations (and bytes) each page kind served.
+inline void pageReport(std::ostream& os) {
+  pageRegistry& r = pageRegions();
+  os << "pages: policy " << page_kind_names[page_policy];
+  for (int k = 0; k < num_page_kinds; k++)
+    if (r.count[k] > 0)
+      os << ", " << page_kind_names[k] << " " << r.count[k] << " (" << r.bytes[k] << " bytes)";
+  os << ", fallbacks " << r.fallbacks << std::endl;
+}
+
+#endif
@@ -37,6 +37,9 @@
 static int getWorkers() {
   return __cilkrts_get_nworkers();
 }
+static int getWorkerNum() {
+  return __cilkrts_get_worker_number();
+}
 static void setWorkers(int n) {
   __cilkrts_end_cilk();
   //__cilkrts_init();
@@ -61,6 +64,9 @@ static void setWorkers(int n) {
 static int getWorkers() {
   return __cilkrts_get_nworkers();
 }
+static int getWorkerNum() {
+  return __cilkrts_get_worker_number();
+}
 static void setWorkers(int n) {
   __cilkrts_end_cilk();
   //__cilkrts_init();
@@ -81,6 +87,7 @@ static void setWorkers(int n) {
 #define parallel_for_1 _Pragma("omp parallel for schedule (static,1)") for
 #define parallel_for_256 _Pragma("omp parallel for schedule (static,256)") for
 static int getWorkers() { return omp_get_max_threads(); }
+static int getWorkerNum() { return omp_get_thread_num(); }
 static void setWorkers(int n) { omp_set_num_threads(n); }
 
 // c++
@@ -93,6 +100,7 @@ static void setWorkers(int n) { omp_set_num_threads(n); }
 #define parallel_for_256 for
 #define cilk_for for
 static int getWorkers() { return 1; }
+static int getWorkerNum() { return 0; }
 static void setWorkers(int n) { }
 
 #endif
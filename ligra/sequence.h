@@ -191,6 +191,45 @@ namespace pbbs {
     return make_array_imap(Out,m);
   }
 
+  // Same as pack, but writes into a caller-provided Out (which must have
+  // room for every flagged element) and returns the number written.
+  template <class Imap_In, class Imap_Fl>
+  size_t pack_at(Imap_In In, typename Imap_In::T* Out, Imap_Fl Fl,
+                 flags fl = no_flag) {
+    size_t n = In.size();
+    size_t l = num_blocks(n,_block_size);
+    if (l <= 1 || fl & fl_sequential) {
+      size_t k = 0;
+      for (size_t i=0; i < n; i++)
+        if (Fl[i]) Out[k++] = In[i];
+      return k;
+    }
+    array_imap<size_t> Sums(l);
+    sliced_for (n, _block_size,
+		[&] (size_t i, size_t s, size_t e)
+		{ Sums[i] = sum_flags_serial(Fl.cut(s,e));});
+    size_t m = scan_add(Sums, Sums);
+    sliced_for (n, _block_size,
+		[&] (size_t i, size_t s, size_t e)
+		{ pack_serial_at(In.cut(s,e),
+				 Out + Sums[i],
+				 Fl.cut(s,e));});
+    return m;
+  }
+
+  template <class Idx_Type, class Imap_Fl>
+  size_t pack_index_at(Imap_Fl Fl, Idx_Type* Out, flags fl = no_flag) {
+    auto identity = [] (size_t i) {return (Idx_Type) i;};
+    return pack_at(make_in_imap<Idx_Type>(Fl.size(),identity), Out, Fl, fl);
+  }
+
+  template <class Idx_Type, class D, class F>
+  size_t pack_index_and_data_at(F& f, size_t size, tuple<Idx_Type, D>* Out, flags fl = no_flag) {
+    auto identity = [&] (size_t i) {return make_tuple((Idx_Type)i, get<1>(f(i))); };
+    auto flgs_in = make_in_imap<bool>(size, [&] (size_t i) { return get<0>(f(i)); });
+    return pack_at(make_in_imap<tuple<Idx_Type, D> >(size,identity), Out, flgs_in, fl);
+  }
+
   template <class Idx_Type, class Imap_Fl>
   array_imap<Idx_Type> pack_index(Imap_Fl Fl, flags fl = no_flag) {
     auto identity = [] (size_t i) {return (Idx_Type) i;};
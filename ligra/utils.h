@@ -28,6 +28,7 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include "parallel.h"
+#include "pageAlloc.h"
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
@@ -47,7 +48,7 @@ static int __jj = mallopt(M_TRIM_THRESHOLD, -1);
 typedef unsigned int uint;
 typedef unsigned long ulong;
 
-#define newA(__E, __n) (__E *)malloc((__n) * sizeof(__E))
+#define newA(__E, __n) (__E *)pageMalloc((__n) * sizeof(__E))
 
 template <class E>
 struct identityF
@@ -548,8 +549,6 @@ void remDuplicates(G &get_key, uintE *flags, long m, long n)
 
 namespace pbbs
 {
-  static int fd = -1;
-  static int pageSize = -1;
   struct empty
   {
   };
@@ -711,117 +710,10 @@ namespace pbbs
     }
     return a;
   }
-  /**
-   * @brief 物理地址转虚拟地址
-   *
-   * @param vaddr
-   * @param paddr
-   * @return 0 is success, -1 is failed!
-   */
-  int mem_addr(unsigned long vaddr, unsigned long *paddr)
-  {
-    if (pageSize == -1)
-    {
-      pageSize = getpagesize(); // //调用此函数获取系统设定的页面大小
-    }
-
-    unsigned long v_pageIndex = vaddr / pageSize;            //计算此虚拟地址相对于0x0的经过的页面数
-    unsigned long v_offset = v_pageIndex * sizeof(uint64_t); //计算在/proc/pid/page_map文件中的偏移量
-    unsigned long page_offset = vaddr % pageSize;            //计算虚拟地址在页面中的偏移量
-    uint64_t item = 0;                                       //存储对应项的值
-
-    if (fd == -1)
-    {
-      fd = open("/proc/self/pagemap", O_RDONLY); //以只读方式打开/proc/pid/page_map
-    }
-    if (fd == -1) //判断是否打开失败
-
-    {
-      printf("open /proc/self/pagemap error\n");
-      return -1;
-    }
-
-    if (lseek(fd, v_offset, SEEK_SET) == -1) //将游标移动到相应位置，即对应项的起始地址且判断是否移动失败
-
-    {
-      printf("sleek error\n");
-      return -1;
-    }
-
-    if (read(fd, &item, sizeof(uint64_t)) != sizeof(uint64_t)) //读取对应项的值，并存入item中，且判断读取数据位数是否正确
-    {
-      printf("read item error\n");
-      return -1;
-    }
-
-    if ((((uint64_t)1 << 63) & item) == 0) //判断present是否为0
-    {
-      printf("page present is 0\n");
-      return -1;
-    }
-
-    uint64_t phy_pageIndex = (((uint64_t)1 << 55) - 1) & item; //计算物理页号，即取item的bit0-54
-
-    *paddr = (phy_pageIndex * pageSize) + page_offset; //再加上页内偏移量就得到了物理地址
-    *paddr = *paddr - 0x80000000;
-    return 0;
-  }
-  /**
-   * @brief 给定两个虚拟地址，和一个打印信息，打印他们的虚拟地址区间和物理地址区间
-   *
-   * @param msg
-   * @param virt_addr
-   */
-  void print_address(const char *msg, unsigned long virt_addr, unsigned long virt_end)
-  {
-    printf("%s [virtual address] : [0x%lx,0x%lx]\n", msg, virt_addr, virt_end);
-    unsigned long phys_start;
-    unsigned long phys_end;
-    /*//read this virtual address to trigger page fault and build the page table.
-    char* start = (char*)virt_addr;
-    char* end = (char*)virt_end;
-    char* p = start;
-    char a ;
-    for(;p<end;p=p+4096){
-        a = *p;
-    }*/
-    int ret1 = mem_addr(virt_addr, &phys_start);
-    int ret2 = mem_addr(virt_end, &phys_end);
-    if (ret1 == 0 && ret2 == 0)
-    {
-      printf("%s [physical address] : [0x%lx,0x%lx]\n", msg, phys_start, phys_end);
-    }
-  }
-  void print_addr(const char *msg, unsigned long virt_addr)
-  {
-    printf("%s [virtual address] : [0x%lx]\n", msg, virt_addr);
-    unsigned long phys_start;
-    int ret1 = mem_addr(virt_addr, &phys_start);
-    if (ret1 == 0)
-    {
-      printf("%s [physical address] : [0x%lx]\n", msg, phys_start);
-    }
-  }
-
-  void print_hugepage_addr(const char *msg, unsigned long start_virt_addr, unsigned long end_virt_addr)
-  {
-    static size_t hugepage = 2097152;
-    unsigned long p = start_virt_addr;
-    for (; p < end_virt_addr; p += hugepage)
-      print_addr(msg, p);
-  }
-
+  // Kept for the apps that use it; see pageAlloc.h.
   void *mmap_huge_page(size_t bytes_to_allocate, const char *msg)
   {
-    int page_num = bytes_to_allocate / 2097152 + 1;
-    size_t mmap_size = page_num * 2097152;
-    void* ret = mmap(NULL, mmap_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
-    if (ret == MAP_FAILED)
-    {
-      printf("%s mmap huge page failed!\n", msg);
-      exit(-1);
-    }
-    return ret;
+    return pageAlloc(bytes_to_allocate, msg);
   }
 
 }
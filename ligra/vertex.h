@@ -3,17 +3,41 @@
 #include "vertexSubset.h"
 using namespace std;
 
+// Optional prefetch hooks used by the prefetching decoders (pf > 0). A
+// frontier may define prefetch(v) to prefetch its entry for v; an edgeMap
+// functor may define prefetchSource(s), for the state update/cond read when
+// s is the source (dense pull), and prefetchTarget(d), for the state they
+// touch when d is the destination (dense forward). Missing hooks are no-ops.
+template <class T>
+inline auto prefetchFrontier(T& t, uintE v, int) -> decltype(t.prefetch(v), void()) { t.prefetch(v); }
+template <class T>
+inline void prefetchFrontier(T& t, uintE v, long) {}
+template <class T>
+inline auto prefetchSource(T& t, uintE v, int) -> decltype(t.prefetchSource(v), void()) { t.prefetchSource(v); }
+template <class T>
+inline void prefetchSource(T& t, uintE v, long) {}
+template <class T>
+inline auto prefetchTarget(T& t, uintE v, int) -> decltype(t.prefetchTarget(v), void()) { t.prefetchTarget(v); }
+template <class T>
+inline void prefetchTarget(T& t, uintE v, long) {}
+
 namespace decode_uncompressed {
 
   // Used by edgeMapDense. Callers ensure cond(v_id). For each vertex, decode
   // its in-edges, and check to see whether this neighbor is in the current
   // frontier, calling update if it is. If processing the edges sequentially,
-  // break once !cond(v_id).
-  template <class vertex, class F, class G, class VS>
+  // break once !cond(v_id). With pf > 0, the frontier entry and source state
+  // of the neighbor pf positions ahead are prefetched.
+  template <long pf, class vertex, class F, class G, class VS>
   inline void decodeInNghBreakEarly(vertex* v, long v_id, VS& vertexSubset, F &f, G &g, bool parallel = 0) {
     uintE d = v->getInDegree();
     if (!parallel || d < 1000) {
       for (size_t j=0; j<d; j++) {
+        if (pf > 0 && j+pf < d) {
+          uintE ahead = v->getInNeighbor(j+pf);
+          prefetchFrontier(vertexSubset, ahead, 0);
+          prefetchSource(f, ahead, 0);
+        }
         uintE ngh = v->getInNeighbor(j);
         if (vertexSubset.isIn(ngh)) {
 #ifndef WEIGHTED
@@ -27,6 +51,11 @@ namespace decode_uncompressed {
       }
     } else {
       parallel_for(size_t j=0; j<d; j++) {
+        if (pf > 0 && j+pf < d) {
+          uintE ahead = v->getInNeighbor(j+pf);
+          prefetchFrontier(vertexSubset, ahead, 0);
+          prefetchSource(f, ahead, 0);
+        }
         uintE ngh = v->getInNeighbor(j);
         if (vertexSubset.isIn(ngh)) {
 #ifndef WEIGHTED
@@ -41,11 +70,13 @@ namespace decode_uncompressed {
   }
 
   // Used by edgeMapDenseForward. For each out-neighbor satisfying cond, call
-  // updateAtomic.
-  template <class V, class F, class G>
+  // updateAtomic. With pf > 0, the target state of the neighbor pf positions
+  // ahead is prefetched.
+  template <long pf, class V, class F, class G>
   inline void decodeOutNgh(V* v, long i, F &f, G &g) {
     uintE d = v->getOutDegree();
     granular_for(j, 0, d, (d > 1000), {
+      if (pf > 0 && j+pf < d) prefetchTarget(f, v->getOutNeighbor(j+pf), 0);
       uintE ngh = v->getOutNeighbor(j);
       if (f.cond(ngh)) {
 #ifndef WEIGHTED
@@ -78,6 +109,29 @@ namespace decode_uncompressed {
     });
   }
 
+  // Out-edges an edgeMapSparse task may take from a high-degree vertex must
+  // start at a multiple of this.
+  const long outSplitUnit = 1;
+
+  // Like decodeOutNghSparse, but sequentially and only for the out-edges
+  // [lo, hi).
+  template <class V, class F, class G>
+  inline void decodeOutNghSparseRange(V* v, long i, uintT o, uintT lo, uintT hi, F &f, G &g) {
+    for (uintT j = lo; j < hi; j++) {
+      uintE ngh = v->getOutNeighbor(j);
+      if (f.cond(ngh)) {
+#ifndef WEIGHTED
+        auto m = f.updateAtomic(i, ngh);
+#else
+        auto m = f.updateAtomic(i, ngh, v->getOutWeight(j));
+#endif
+        g(ngh, o+j, m);
+      } else {
+        g(ngh, o+j);
+      }
+    }
+  }
+
   // Used by edgeMapSparse_no_filter. Sequentially decode the out-neighbors,
   // and compactly write all neighbors satisfying g().
   template <class V, class F, class G>
@@ -237,14 +291,14 @@ symmetricVertex(intE* n, uintT d)
   void setOutDegree(uintT _d) { degree = _d; }
   void flipEdges() {}
 
-  template <class VS, class F, class G>
+  template <long pf = 0, class VS, class F, class G>
   inline void decodeInNghBreakEarly(long v_id, VS& vertexSubset, F &f, G &g, bool parallel = 0) {
-    decode_uncompressed::decodeInNghBreakEarly<symmetricVertex, F, G, VS>(this, v_id, vertexSubset, f, g, parallel);
+    decode_uncompressed::decodeInNghBreakEarly<pf, symmetricVertex, F, G, VS>(this, v_id, vertexSubset, f, g, parallel);
   }
 
-  template <class F, class G>
+  template <long pf = 0, class F, class G>
   inline void decodeOutNgh(long i, F &f, G& g) {
-     decode_uncompressed::decodeOutNgh<symmetricVertex, F, G>(this, i, f, g);
+     decode_uncompressed::decodeOutNgh<pf, symmetricVertex, F, G>(this, i, f, g);
   }
 
   template <class F, class G>
@@ -257,6 +311,13 @@ symmetricVertex(intE* n, uintT d)
     return decode_uncompressed::decodeOutNghSparseSeq<symmetricVertex, F>(this, i, o, f, g);
   }
 
+  static long outSplitUnit() { return decode_uncompressed::outSplitUnit; }
+
+  template <class F, class G>
+  inline void decodeOutNghSparseRange(long i, uintT o, uintT lo, uintT hi, F &f, G &g) {
+    decode_uncompressed::decodeOutNghSparseRange<symmetricVertex, F>(this, i, o, lo, hi, f, g);
+  }
+
   template <class E, class F, class G>
   inline void copyOutNgh(long i, uintT o, F& f, G& g) {
     decode_uncompressed::copyOutNgh<symmetricVertex, E>(this, i, o, f, g);
@@ -323,14 +384,14 @@ asymmetricVertex(intE* iN, intE* oN, uintT id, uintT od)
   void setOutDegree(uintT _d) { outDegree = _d; }
   void flipEdges() { swap(inNeighbors,outNeighbors); swap(inDegree,outDegree); }
 
-  template <class VS, class F, class G>
+  template <long pf = 0, class VS, class F, class G>
   inline void decodeInNghBreakEarly(long v_id, VS& vertexSubset, F &f, G &g, bool parallel = 0) {
-    decode_uncompressed::decodeInNghBreakEarly<asymmetricVertex, F, G, VS>(this, v_id, vertexSubset, f, g, parallel);
+    decode_uncompressed::decodeInNghBreakEarly<pf, asymmetricVertex, F, G, VS>(this, v_id, vertexSubset, f, g, parallel);
   }
 
-  template <class F, class G>
+  template <long pf = 0, class F, class G>
   inline void decodeOutNgh(long i, F &f, G &g) {
-    decode_uncompressed::decodeOutNgh<asymmetricVertex, F, G>(this, i, f, g);
+    decode_uncompressed::decodeOutNgh<pf, asymmetricVertex, F, G>(this, i, f, g);
   }
 
   template <class F, class G>
@@ -343,6 +404,13 @@ asymmetricVertex(intE* iN, intE* oN, uintT id, uintT od)
     return decode_uncompressed::decodeOutNghSparseSeq<asymmetricVertex, F>(this, i, o, f, g);
   }
 
+  static long outSplitUnit() { return decode_uncompressed::outSplitUnit; }
+
+  template <class F, class G>
+  inline void decodeOutNghSparseRange(long i, uintT o, uintT lo, uintT hi, F &f, G &g) {
+    decode_uncompressed::decodeOutNghSparseRange<asymmetricVertex, F>(this, i, o, lo, hi, f, g);
+  }
+
   template <class E, class F, class G>
   inline void copyOutNgh(long i, uintT o, F& f, G& g) {
     decode_uncompressed::copyOutNgh<asymmetricVertex, E>(this, i, o, f, g);
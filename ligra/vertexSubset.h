@@ -6,9 +6,97 @@
 #include "index_map.h"
 #include "maybe.h"
 #include "sequence.h"
+#include "frontierPool.h"
 
 using namespace std;
 
+// Bit-packed dense frontiers (the dense_bitmap flag): vertex v is bit v%64 of
+// word v/64, and bits past n in the last word are always zero.
+inline size_t bitmapWords(size_t n) { return (n + 63) / 64; }
+
+inline bool bitmapIn(const uint64_t* bits, size_t v) {
+  return (bits[v >> 6] >> (v & 63)) & 1;
+}
+
+// Sets bit v when other workers may be writing the same word. The plain read
+// first skips the atomic for vertices that are already set.
+inline void bitmapSetAtomic(uint64_t* bits, size_t v) {
+  uint64_t mask = ((uint64_t)1) << (v & 63);
+  if (!(bits[v >> 6] & mask)) __sync_fetch_and_or(&bits[v >> 6], mask);
+}
+
+// Sets bit v and returns true iff this call changed it from 0 to 1.
+inline bool bitmapTestAndSet(uint64_t* bits, size_t v) {
+  uint64_t mask = ((uint64_t)1) << (v & 63);
+  if (bits[v >> 6] & mask) return false;
+  return !(__sync_fetch_and_or(&bits[v >> 6], mask) & mask);
+}
+
+inline void bitmapClearAtomic(uint64_t* bits, size_t v) {
+  __sync_fetch_and_and(&bits[v >> 6], ~(((uint64_t)1) << (v & 63)));
+}
+
+inline size_t bitmapCount(const uint64_t* bits, size_t n) {
+  auto c = make_in_imap<size_t>(bitmapWords(n), [&] (size_t w) {
+      return (size_t)__builtin_popcountll(bits[w]); });
+  return pbbs::reduce_add(c);
+}
+
+// Calls f(v) for each vertex v whose bit is set in word w of a bitmap.
+template <class F>
+inline void bitmapForWord(uint64_t word, size_t w, F f) {
+  while (word) {
+    f((w << 6) + __builtin_ctzll(word));
+    word &= word - 1;
+  }
+}
+
+// Read-only view of a bitmap frontier, passed in place of the vertexSubset to
+// the decoders so that their isIn probes go straight to the bits.
+struct bitmapView {
+  const uint64_t* bits;
+  bitmapView(const uint64_t* _bits) : bits(_bits) {}
+  inline bool isIn(const uintE& v) const { return bitmapIn(bits, v); }
+  inline void prefetch(const uintE& v) const { __builtin_prefetch(&bits[v >> 6]); }
+};
+
+// Frontier summaries (the dense_block_skip flag): bit b of a summary is set
+// iff block b, the 2^summaryBlockShift vertices starting at b <<
+// summaryBlockShift, holds an active vertex. Even for a billion vertices the
+// summary is 256KB.
+const size_t summaryBlockShift = 9;
+
+inline size_t summaryBlocks(size_t n) {
+  return (n + ((size_t)1 << summaryBlockShift) - 1) >> summaryBlockShift;
+}
+
+// Block b folded onto one bit of a word. A summary's fold is the OR of its
+// words, so a set of blocks whose fold misses it has no active block.
+inline uint64_t blockFoldBit(size_t v) {
+  return ((uint64_t)1) << ((v >> summaryBlockShift) & 63);
+}
+
+// View that checks the summary, which stays in cache, before probing the
+// frontier itself.
+template <class VS>
+struct summaryView {
+  VS& vs;
+  const uint64_t* summary;
+  summaryView(VS& _vs, const uint64_t* _summary) : vs(_vs), summary(_summary) {}
+  inline bool isIn(const uintE& v) const {
+    return bitmapIn(summary, v >> summaryBlockShift) && vs.isIn(v);
+  }
+  inline void prefetch(const uintE& v) const { vs.prefetch(v); }
+};
+
+// Ownership of a vertexSubset's representations. A set owns, and del()
+// frees, the arrays it was constructed from and those its conversions
+// allocate. Arrays handed out by a frontierPool are borrowed: the pool
+// recycles them (see reuse_frontier), so del() leaves them alone. Copies
+// alias the same arrays and exactly one of them should be del()eted; moving
+// a set transfers its ownership and leaves the source borrowing.
+enum { own_s = 1, own_d = 2, own_bits = 4, own_summary = 8, own_all = 15 };
+
 template <class data>
 struct vertexSubsetData {
   using S = tuple<uintE, data>;
@@ -36,12 +124,25 @@ struct vertexSubsetData {
   vertexSubsetData()
   : n(0), m(0), s(NULL), d(NULL), isDense(0) { }
 
+  vertexSubsetData(const vertexSubsetData&) = default;
+  vertexSubsetData& operator=(const vertexSubsetData&) = default;
+  vertexSubsetData(vertexSubsetData&& o) : vertexSubsetData(o) { o.owned = 0; }
+  vertexSubsetData& operator=(vertexSubsetData&& o) {
+    if (this != &o) { *this = (const vertexSubsetData&)o; o.owned = 0; }
+    return *this;
+  }
+
+  // Frees the owned representations and leaves the set empty.
   void del() {
-    /*if(!shouldFree)return;
-    if (d != NULL) free(d);
-    if (s != NULL) free(s);*/
+    if (owned & own_d) pageFree(d);
+    if (owned & own_s) pageFree(s);
+    s = NULL; d = NULL; m = 0; isDense = 0;
   }
 
+  // Marks every representation as borrowed, e.g. from a frontierPool.
+  void borrow() { owned = 0; }
+  void setOwned(int which, bool own) { owned = own ? (owned | which) : (owned & ~which); }
+
   // Sparse
   inline uintE& vtx(const uintE& i) const { return std::get<0>(s[i]); }
   inline data& vtxData(const uintE& i) const { return std::get<1>(s[i]); }
@@ -49,6 +150,7 @@ struct vertexSubsetData {
 
   // Dense
   inline bool isIn(const uintE& v) const { return std::get<0>(d[v]); }
+  inline void prefetch(const uintE& v) const { __builtin_prefetch(&d[v]); }
   inline data& ithData(const uintE& v) const { return std::get<1>(d[v]); }
 
   // Returns (uintE) -> Maybe<tuple<vertex, vertex-data>>.
@@ -76,14 +178,25 @@ struct vertexSubsetData {
 
   bool isEmpty() const { return m==0; }
   bool dense() const { return isDense; }
+  bool hasDenseRepr() const { return d != NULL; }
 
-  void toSparse() {
+  // If pool is non-null the sparse representation is written into the
+  // pool's buffer for the current frontier instead of a fresh allocation.
+  void toSparse(frontierPool* pool = NULL) {
     if (s == NULL && m > 0) {
       auto f = make_in_imap<D>(n, [&] (size_t i) -> tuple<bool, data> { return d[i]; });
-      auto out = pbbs::pack_index_and_data<uintE, data>(f, n);
-      out.alloc = false;
-      s = out.s;
-      if (out.size() != m) {
+      size_t k;
+      if (pool != NULL) {
+        s = pool->curSparse<S>(m);
+        k = pbbs::pack_index_and_data_at<uintE, data>(f, n, s);
+      } else {
+        auto out = pbbs::pack_index_and_data<uintE, data>(f, n);
+        out.alloc = false;
+        s = out.s;
+        k = out.size();
+      }
+      setOwned(own_s, pool == NULL);
+      if (k != m) {
         cout << "bad stored value of m" << endl;
         abort();
       }
@@ -92,50 +205,25 @@ struct vertexSubsetData {
   }
 
   // Convert to dense but keep sparse representation if it exists.
-  void toDense() {
+  // With a pool, the recycled buffer is cleared only where the previous
+  // conversion set it (see frontierPool::curDenseClear).
+  void toDense(frontierPool* pool = NULL) {
     if (d == NULL) {
-      d = newA(D, n);
-      {parallel_for(long i=0;i<n;i++) std::get<0>(d[i]) = false;}
+      if (pool != NULL) d = pool->curDenseClear<D>(n);
+      else {
+        d = newA(D, n);
+        {parallel_for(long i=0;i<n;i++) std::get<0>(d[i]) = false;}
+      }
+      setOwned(own_d, pool == NULL);
       {parallel_for(long i=0;i<m;i++)
         d[std::get<0>(s[i])] = make_tuple(true, std::get<1>(s[i]));}
+      if (pool != NULL) pool->markDense([&] (size_t i) { return std::get<0>(s[i]); }, m, n);
     }
     isDense = true;
   }
-  void setShouldFree(bool b){
-    shouldFree = b;
-  }
-  void setS(S* newPointer, size_t size){
-    if (s!=NULL){
-      memcpy(newPointer,s,sizeof(S)*m);
-      free(s);
-    }
-    s = newPointer;
-    s_size = size;
-  }
-  void setD(D* newPointer, size_t size){
-    if(d!=NULL){
-      memcpy(newPointer,d,sizeof(D)*n);
-      free(d);
-    }
-    d = newPointer;
-    d_size = size;
-  }
-  size_t getD_size(){
-    return d_size;
-  }
-  size_t getS_size(){
-    return s_size;
-  }
-  S* getS(){
-    return s;
-  }
-  D* getD(){
-    return d;
-  }
-  size_t d_size,s_size;
   S* s;
   D* d;
-  bool shouldFree = true;
+  int owned = own_all;
   size_t n, m;
   bool isDense;
 };
@@ -145,45 +233,45 @@ template <>
 struct vertexSubsetData<pbbs::empty> {
   using S = uintE;
 
+  vertexSubsetData<pbbs::empty>()
+  : n(0), m(0), d(NULL), s(NULL), bits(NULL), isDense(0) {}
+
   // An empty vertex set.
-  vertexSubsetData<pbbs::empty>(size_t _n) : n(_n), m(0), d(NULL), s(NULL), isDense(0) {}
+  vertexSubsetData<pbbs::empty>(size_t _n) : n(_n), m(0), d(NULL), s(NULL), bits(NULL), isDense(0) {}
  
   // A vertexSubset with a single vertex.
   vertexSubsetData<pbbs::empty>(long _n, uintE v)
-  : n(_n), m(1), d(NULL), isDense(0) {
+  : n(_n), m(1), d(NULL), bits(NULL), isDense(0) {
     s = newA(uintE, 1);
     s[0] = v;
   }
 
 
   void refresh(long _n, uintE v) {
+    del();
     n=_n;
     m=1;
-    d = NULL;
-    isDense = 0;
-    if(s!=NULL){
-      free(s);
-    }
     s = newA(uintE,1);
     s[0] = v;
+    owned = own_all;
   }
 
   // A vertexSubset from array of vertex indices.
   vertexSubsetData<pbbs::empty>(long _n, long _m, S* indices)
-  : n(_n), m(_m), s(indices), d(NULL), isDense(0) {}
+  : n(_n), m(_m), s(indices), d(NULL), bits(NULL), isDense(0) {}
 
   // A vertexSubset from array of vertex indices.
   vertexSubsetData<pbbs::empty>(long _n, long _m, tuple<uintE, pbbs::empty>* indices)
-  : n(_n), m(_m), s((uintE*)indices), d(NULL), isDense(0) {}
+  : n(_n), m(_m), s((uintE*)indices), d(NULL), bits(NULL), isDense(0) {}
 
   // A vertexSubset from boolean array giving number of true values.
   vertexSubsetData<pbbs::empty>(long _n, long _m, bool* _d)
-  : n(_n), m(_m), s(NULL), d(_d), isDense(1)  {}
+  : n(_n), m(_m), s(NULL), d(_d), bits(NULL), isDense(1)  {}
 
   // A vertexSubset from boolean array giving number of true values. Calculate
   // number of nonzeros and store in m.
   vertexSubsetData<pbbs::empty>(long _n, bool* _d)
-  : n(_n), s(NULL), d(_d), isDense(1) {
+  : n(_n), s(NULL), d(_d), bits(NULL), isDense(1) {
     auto d_map = make_in_imap<size_t>(n, [&] (size_t i) { return _d[i]; });
     auto f = [&] (size_t i, size_t j) { return i + j; };
     m = pbbs::reduce(d_map, f);
@@ -192,25 +280,51 @@ struct vertexSubsetData<pbbs::empty> {
   // A vertexSubset from boolean array giving number of true values. Calculate
   // number of nonzeros and store in m.
  vertexSubsetData<pbbs::empty>(long _n, tuple<bool, pbbs::empty>* _d)
-  : n(_n), s(NULL), d((bool*)_d), isDense(1)  {
+  : n(_n), s(NULL), d((bool*)_d), bits(NULL), isDense(1)  {
     auto d_map = make_in_imap<size_t>(n, [&] (size_t i) { return get<0>(_d[i]); });
     auto f = [&] (size_t i, size_t j) { return i + j; };
     m = pbbs::reduce(d_map, f);
   }
 
+  // A vertexSubset from a bitmap of bitmapWords(n) words. Calculate number of
+  // nonzeros and store in m.
+  vertexSubsetData<pbbs::empty>(long _n, uint64_t* _bits)
+  : n(_n), s(NULL), d(NULL), bits(_bits), isDense(1) {
+    m = bitmapCount(bits, n);
+  }
+
+  vertexSubsetData<pbbs::empty>(const vertexSubsetData<pbbs::empty>&) = default;
+  vertexSubsetData<pbbs::empty>& operator=(const vertexSubsetData<pbbs::empty>&) = default;
+  vertexSubsetData<pbbs::empty>(vertexSubsetData<pbbs::empty>&& o)
+  : vertexSubsetData<pbbs::empty>(o) { o.owned = 0; }
+  vertexSubsetData<pbbs::empty>& operator=(vertexSubsetData<pbbs::empty>&& o) {
+    if (this != &o) { *this = (const vertexSubsetData<pbbs::empty>&)o; o.owned = 0; }
+    return *this;
+  }
+
+  // Frees the owned representations and leaves the set empty.
   void del() {
-    /*if(!shouldFree)return;
-    if (d != NULL) free(d);
-    if (s != NULL) free(s);*/
+    if (owned & own_d) pageFree(d);
+    if (owned & own_s) pageFree(s);
+    if (owned & own_bits) pageFree(bits);
+    if (owned & own_summary) pageFree(summary);
+    s = NULL; d = NULL; bits = NULL; summary = NULL; m = 0; isDense = 0;
   }
 
+  // Marks every representation as borrowed, e.g. from a frontierPool.
+  void borrow() { owned = 0; }
+  void setOwned(int which, bool own) { owned = own ? (owned | which) : (owned & ~which); }
+
   // Sparse
   inline uintE& vtx(const uintE& i) const { return s[i]; }
   inline pbbs::empty vtxData(const uintE& i) const { return pbbs::empty(); }
   inline tuple<uintE, pbbs::empty> vtxAndData(const uintE& i) const { return make_tuple(s[i], pbbs::empty()); }
 
   // Dense
-  inline bool isIn(const uintE& v) const { return d[v]; }
+  inline bool isIn(const uintE& v) const {
+    return (d != NULL) ? d[v] : bitmapIn(bits, v); }
+  inline void prefetch(const uintE& v) const {
+    __builtin_prefetch((d != NULL) ? (const void*)&d[v] : (const void*)&bits[v >> 6]); }
   inline pbbs::empty ithData(const uintE& v) const { return pbbs::empty(); }
 
   // Returns (uintE) -> Maybe<tuple<vertex, vertex-data>>.
@@ -219,7 +333,7 @@ struct vertexSubsetData<pbbs::empty> {
     if (isDense) {
       fn = [&] (const uintE& v) -> Maybe<tuple<uintE, pbbs::empty>> {
         auto ret = Maybe<tuple<uintE, pbbs::empty>>(make_tuple(v, pbbs::empty()));
-        ret.exists = d[v];
+        ret.exists = isIn(v);
         return ret;
       };
     } else {
@@ -242,18 +356,54 @@ struct vertexSubsetData<pbbs::empty> {
 
   bool isEmpty() { return m==0; }
   bool dense() { return isDense; }
-
-  void toSparse() {
-    if (s == NULL && m > 0) {
+  bool hasDenseRepr() const { return d != NULL || bits != NULL; }
+
+  // If pool is non-null the sparse representation is written into the
+  // pool's buffer for the current frontier instead of a fresh allocation.
+  void toSparse(frontierPool* pool = NULL) {
+    if (s == NULL && m > 0 && d == NULL && bits != NULL) {
+      s = (pool != NULL) ? pool->curSparse<uintE>(m) : newA(uintE, m);
+      setOwned(own_s, pool == NULL);
+      // Count per block of words, then write each block's vertices at its
+      // offset, skipping empty words.
+      size_t nw = bitmapWords(n), bsize = 1024, nb = (nw + bsize - 1) / bsize;
+      size_t* offs = newA(size_t, nb);
+      {parallel_for(size_t b = 0; b < nb; b++) {
+        size_t c = 0, end = min(nw, (b+1)*bsize);
+        for (size_t w = b*bsize; w < end; w++) c += __builtin_popcountll(bits[w]);
+        offs[b] = c;
+      }}
+      size_t k = sequence::plusScan(offs, offs, (intT)nb);
+      {parallel_for(size_t b = 0; b < nb; b++) {
+        uintE* out = s + offs[b];
+        size_t end = min(nw, (b+1)*bsize);
+        for (size_t w = b*bsize; w < end; w++)
+          if (bits[w]) bitmapForWord(bits[w], w, [&] (size_t v) { *out++ = v; });
+      }}
+      free(offs);
+      if (k != m) {
+        cout << "bad stored value of m" << endl;
+        cout << "out.size = " << k << " m = " << m << " n = " << n << endl;
+        abort();
+      }
+    } else if (s == NULL && m > 0) {
       auto _d = d;
       auto f = [&] (size_t i) { return _d[i]; };
       auto f_in = make_in_imap<bool>(n, f);
-      auto out = pbbs::pack_index<uintE>(f_in);
-      out.alloc = false;
-      s = out.s;
-      if (out.size() != m) {
+      size_t k;
+      if (pool != NULL) {
+        s = pool->curSparse<uintE>(m);
+        k = pbbs::pack_index_at<uintE>(f_in, s);
+      } else {
+        auto out = pbbs::pack_index<uintE>(f_in);
+        out.alloc = false;
+        s = out.s;
+        k = out.size();
+      }
+      setOwned(own_s, pool == NULL);
+      if (k != m) {
         cout << "bad stored value of m" << endl;
-        cout << "out.size = " << out.size() << " m = " << m << " n = " << n << endl;
+        cout << "out.size = " << k << " m = " << m << " n = " << n << endl;
         abort();
       }
     }
@@ -261,49 +411,97 @@ struct vertexSubsetData<pbbs::empty> {
   }
 
   // Converts to dense but keeps sparse representation if it exists.
-  void toDense() {
+  // From a sparse set with a pool, the recycled buffer is cleared only where
+  // the previous conversion set it (see frontierPool::curDenseClear).
+  void toDense(frontierPool* pool = NULL) {
     if (d == NULL) {
-      d = newA(bool,n);
-      {parallel_for(long i=0;i<n;i++) d[i] = 0;}
-      {parallel_for(long i=0;i<m;i++) d[s[i]] = 1;}
+      if (s == NULL && bits != NULL) {
+        d = (pool != NULL) ? pool->curDense<bool>(n) : newA(bool,n);
+        parallel_for(long i=0;i<n;i++) d[i] = bitmapIn(bits, i);
+        setOwned(own_d, pool == NULL);
+      } else {
+        if (pool != NULL) d = pool->curDenseClear<bool>(n);
+        else {
+          d = newA(bool,n);
+          {parallel_for(long i=0;i<n;i++) d[i] = 0;}
+        }
+        setOwned(own_d, pool == NULL);
+        {parallel_for(long i=0;i<m;i++) d[s[i]] = 1;}
+        if (pool != NULL) pool->markDense([&] (size_t i) { return s[i]; }, m, n);
+      }
     }
     isDense = true;
   }
-  void setShouldFree(bool b){
-    shouldFree = b;
-  }
-  void setS(S* newPointer, size_t size){
-    if (s!=NULL){
-      memcpy(newPointer,s,sizeof(S)*m);
-      free(s);
+
+  // Converts to the bitmap representation, keeping the others if they exist.
+  void toBits(frontierPool* pool = NULL) {
+    if (bits == NULL) {
+      size_t nw = bitmapWords(n);
+      if (d != NULL) {
+        bits = (pool != NULL) ? pool->curBits(nw) : newA(uint64_t, nw);
+        setOwned(own_bits, pool == NULL);
+        parallel_for(size_t w = 0; w < nw; w++) {
+          uint64_t word = 0;
+          size_t end = min((size_t)n, (w+1)*64);
+          for (size_t v = w*64; v < end; v++) word |= ((uint64_t)d[v]) << (v & 63);
+          bits[w] = word;
+        }
+      } else {
+        if (pool != NULL) bits = pool->curBitsClear(nw);
+        else {
+          bits = newA(uint64_t, nw);
+          {parallel_for(size_t w = 0; w < nw; w++) bits[w] = 0;}
+        }
+        setOwned(own_bits, pool == NULL);
+        {parallel_for(size_t i = 0; i < m; i++) bitmapSetAtomic(bits, s[i]);}
+        if (pool != NULL) pool->markBits([&] (size_t i) { return s[i]; }, m, n);
+      }
     }
-    s = newPointer;
-    s_size = size;
+    isDense = true;
   }
-  void setD(bool* newPointer, size_t size){
-    if(d!=NULL){
-      memcpy(newPointer,d,sizeof(bool)*n);
-      free(d);
+  // Builds the frontier summary from whichever representation exists.
+  void toSummary(frontierPool* pool = NULL) {
+    if (summary != NULL) return;
+    size_t nb = summaryBlocks(n), nw = bitmapWords(nb);
+    summary = (pool != NULL) ? pool->curSummary(nw) : newA(uint64_t, nw);
+    setOwned(own_summary, pool == NULL);
+    if (s != NULL) {
+      {parallel_for(size_t w = 0; w < nw; w++) summary[w] = 0;}
+      {parallel_for(size_t i = 0; i < m; i++)
+        bitmapSetAtomic(summary, s[i] >> summaryBlockShift);}
+      return;
+    }
+    size_t bsize = (size_t)1 << summaryBlockShift;
+    parallel_for(size_t w = 0; w < nw; w++) {
+      uint64_t word = 0;
+      size_t end = min(nb, (w+1)*64);
+      for (size_t b = w*64; b < end; b++) {
+        bool any = false;
+        if (d != NULL) {
+          for (size_t v = b*bsize; v < min((size_t)n, (b+1)*bsize) && !any; v++) any = d[v];
+        } else {
+          size_t bw = bsize / 64;
+          for (size_t i = b*bw; i < min(bitmapWords(n), (b+1)*bw) && !any; i++) any = bits[i];
+        }
+        if (any) word |= ((uint64_t)1) << (b & 63);
+      }
+      summary[w] = word;
     }
-    d = newPointer;
-    d_size = size;
-  }
-  size_t getD_size(){
-    return d_size;
-  }
-  size_t getS_size(){
-    return s_size;
-  }
-  S* getS(){
-    return s;
   }
-  bool* getD(){
-    return d;
+
+  // OR of the summary's words; see blockFoldBit.
+  uint64_t summaryFold() {
+    auto words = make_in_imap<uint64_t>(bitmapWords(summaryBlocks(n)),
+                                        [&] (size_t w) { return summary[w]; });
+    auto f = [&] (uint64_t a, uint64_t b) { return a | b; };
+    return pbbs::reduce(words, f);
   }
-  size_t d_size,s_size;
+
   S* s;
   bool* d;
-  bool shouldFree = true;
+  uint64_t* bits;
+  uint64_t* summary = NULL;
+  int owned = own_all;
   size_t n, m;
   bool isDense;
 };
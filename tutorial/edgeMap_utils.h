@@ -0,0 +1 @@
+../ligra/edgeMap_utils.h
\ No newline at end of file
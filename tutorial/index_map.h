@@ -0,0 +1 @@
+../ligra/index_map.h
\ No newline at end of file
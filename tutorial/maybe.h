@@ -0,0 +1 @@
+../ligra/maybe.h
\ No newline at end of file
@@ -0,0 +1 @@
+../ligra/quickSort.h
\ No newline at end of file